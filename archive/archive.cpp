@@ -0,0 +1,431 @@
+#include "../main.h"
+
+static constexpr char GZIP_HEADER[] = { 0x1F, (char)0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, (char)0xFF };
+static constexpr char ZERO_BLOCK[1024] = {};
+
+ArchiveWriter::ArchiveWriter(const std::string& filePath, const bool& isCompressed) : filePath(filePath), isCompressed(isCompressed) {}
+
+bool ArchiveWriter::open() {
+	modifiedTime = std::time(nullptr);
+	if (!file.create(filePath)) return false;
+	if (isCompressed) deflate.output.assign(GZIP_HEADER, sizeof(GZIP_HEADER));
+	return true;
+}
+
+bool ArchiveWriter::add_file(const std::string& filePath, const std::string& data) {
+	std::string path = filePath;
+	std::replace(path.begin(), path.end(), PATH_SEPARATOR, '/');
+	add_directories(path);
+	write_header(path, data.size(), '0');
+	write(data.data(), data.size());
+	write_padding(data.size());
+	return !isFailed;
+}
+
+bool ArchiveWriter::close() {
+	write(ZERO_BLOCK, sizeof(ZERO_BLOCK));
+
+	if (isCompressed) {
+		deflate.finish();
+
+		for (uint8_t i = 0; i < 4; i++) {
+			deflate.output += (char)(crc >> (i * 8));
+		}
+
+		for (uint8_t i = 0; i < 4; i++) {
+			deflate.output += (char)(dataSize >> (i * 8));
+		}
+	}
+
+	flush();
+	file.close();
+	return !isFailed;
+}
+
+void ArchiveWriter::add_directories(const std::string& path) {
+	for (size_t i = path.find('/'); i != std::string::npos; i = path.find('/', i + 1)) {
+		if (!directories.emplace(path.substr(0, i + 1), true).second) continue;
+		write_header(path.substr(0, i + 1), 0, '5');
+	}
+}
+
+void ArchiveWriter::write_header(const std::string& path, const uint64_t& size, const char& type) {
+	char header[BLOCK_SIZE] = {};
+	std::string name = path;
+	std::string prefix;
+
+	for (size_t i = name.find('/'); name.size() > 100 && i != std::string::npos && i <= 155; i = name.find('/', i + 1)) {
+		if (name.size() - i - 1 > 100 || name.size() - i - 1 == 0) continue;
+		prefix = name.substr(0, i);
+		name.erase(0, i + 1);
+	}
+
+	if (name.size() > 100) {
+		const std::string record = " path=" + path + "\n";
+		uint64_t recordSize = record.size() + 1;
+		while (std::to_string(recordSize).size() + record.size() != recordSize) recordSize++;
+		write_header(PAX_HEADER_NAME, recordSize, 'x');
+		write((std::to_string(recordSize) + record).data(), recordSize);
+		write_padding(recordSize);
+		name.resize(100);
+	}
+
+	std::memcpy(header, name.data(), name.size());
+	std::snprintf(header + 100, 8, "%07o", type == '5' ? 0755 : 0644);
+	std::snprintf(header + 108, 8, "%07o", 0);
+	std::snprintf(header + 116, 8, "%07o", 0);
+	std::snprintf(header + 124, 12, "%011" PRIo64, size);
+	std::snprintf(header + 136, 12, "%011" PRIo64, modifiedTime);
+	std::memset(header + 148, ' ', 8);
+	header[156] = type;
+	std::memcpy(header + 257, "ustar", 6);
+	std::memcpy(header + 263, "00", 2);
+	std::memcpy(header + 345, prefix.data(), prefix.size());
+	uint32_t checksum = 0;
+
+	for (uint32_t i = BLOCK_SIZE; i--;) {
+		checksum += (uint8_t)header[i];
+	}
+
+	std::snprintf(header + 148, 7, "%06o", checksum);
+	header[155] = ' ';
+	write(header, BLOCK_SIZE);
+}
+
+void ArchiveWriter::write_padding(const uint64_t& size) {
+	if (size % BLOCK_SIZE) write(ZERO_BLOCK, BLOCK_SIZE - size % BLOCK_SIZE);
+}
+
+void ArchiveWriter::write(const char* const& data, const uint64_t& size) {
+	if (!isCompressed) {
+		buffer.append(data, size);
+		if (buffer.size() >= FLUSH_SIZE) flush();
+		return;
+	}
+
+	crc = update_crc32(crc, (const uint8_t*)data, size);
+	dataSize += size;
+	deflate.write((const uint8_t*)data, size);
+	if (deflate.output.size() >= FLUSH_SIZE) flush();
+}
+
+void ArchiveWriter::flush() {
+	std::string& output = isCompressed ? deflate.output : buffer;
+	if (!isFailed && output.size() && !file.write(output.data(), output.size())) isFailed = true;
+	output.clear();
+}
+
+static uint64_t read_little_endian(const uint8_t* const& data, const uint8_t& size) {
+	uint64_t value = 0;
+
+	for (uint8_t i = size; i--;) {
+		value = (value << 8) | data[i];
+	}
+
+	return value;
+}
+
+static uint64_t read_octal(const uint8_t* const& data, const uint8_t& size) {
+	uint64_t value = 0;
+
+	if (data[0] & 0x80) {
+		for (uint8_t i = 1; i < size; i++) {
+			value = (value << 8) | data[i];
+		}
+
+		return value;
+	}
+
+	for (uint8_t i = 0; i < size && data[i] >= '0' && data[i] <= '7'; i++) {
+		value = (value << 3) | (data[i] - '0');
+	}
+
+	return value;
+}
+
+ArchiveReader::ArchiveReader(const std::string& filePath, const DirectoryWalker::FileFilter& filter) : filePath(filePath), filter(filter) {}
+
+bool ArchiveReader::open() {
+	InputFile file;
+	if (!file.open(filePath)) return false;
+	data.resize(file.size);
+
+	for (uint64_t offset = 0; offset < data.size(); offset += READ_SIZE) {
+		if (!file.read(data.data() + offset, data.size() - offset < READ_SIZE ? data.size() - offset : READ_SIZE)) return false;
+	}
+
+	if (data.size() >= 4 && data[0] == 'P' && data[1] == 'K') return open_zip();
+	if (data.size() >= 2 && data[0] == 0x1F && data[1] == 0x8B) return open_gzip();
+	format = FORMAT_TAR;
+	return true;
+}
+
+bool ArchiveReader::next_file(File& file) {
+	if (isFailed) return false;
+	return format == FORMAT_ZIP ? next_zip_file(file) : next_tar_file(file);
+}
+
+bool ArchiveReader::open_gzip() {
+	if (data.size() < 10 || data[2] != 0x08) return false;
+	const uint8_t flags = data[3];
+	position = 10;
+	if (flags & 0x04) position += data.size() >= 12 ? 2 + read_little_endian(data.data() + 10, 2) : data.size();
+	if (flags & 0x08) while (position < data.size() && data[position++]);
+	if (flags & 0x10) while (position < data.size() && data[position++]);
+	if (flags & 0x02) position += 2;
+	if (position >= data.size()) return false;
+	inflate.begin(data.data() + position, data.size() - position);
+	format = FORMAT_GZIP;
+	return true;
+}
+
+bool ArchiveReader::open_zip() {
+	if (data.size() < 22) return false;
+	const uint64_t searchLimit = data.size() > 0xFFFF + 22 ? data.size() - 0xFFFF - 22 : 0;
+	uint64_t endPosition = data.size() - 22;
+
+	while (read_little_endian(data.data() + endPosition, 4) != 0x06054B50) {
+		if (endPosition == searchLimit) return false;
+		endPosition--;
+	}
+
+	remainingEntries = read_little_endian(data.data() + endPosition + 10, 2);
+	position = read_little_endian(data.data() + endPosition + 16, 4);
+
+	if ((remainingEntries == 0xFFFF || position == 0xFFFFFFFF)
+		&& endPosition >= 20
+		&& read_little_endian(data.data() + endPosition - 20, 4) == 0x07064B50) {
+		const uint64_t zip64EndPosition = read_little_endian(data.data() + endPosition - 12, 8);
+		if (data.size() < 56 || zip64EndPosition > data.size() - 56 || read_little_endian(data.data() + zip64EndPosition, 4) != 0x06064B50) return false;
+		remainingEntries = read_little_endian(data.data() + zip64EndPosition + 32, 8);
+		position = read_little_endian(data.data() + zip64EndPosition + 48, 8);
+	}
+
+	format = FORMAT_ZIP;
+	return position <= data.size();
+}
+
+bool ArchiveReader::next_tar_file(File& file) {
+	uint8_t header[BLOCK_SIZE];
+	std::string overridePath;
+	std::string entryPath;
+	uint64_t size, paddedSize;
+	uint32_t checksum;
+
+	while (read(header, BLOCK_SIZE)) {
+		checksum = 8 * ' ';
+
+		for (uint32_t i = BLOCK_SIZE; i--;) {
+			if (i < 148 || i >= 156) checksum += header[i];
+		}
+
+		if (checksum == 8 * ' ') return false;
+
+		if (checksum != read_octal(header + 148, 8)) {
+			isFailed = true;
+			return false;
+		}
+
+		size = read_octal(header + 124, 12);
+		paddedSize = (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+		switch (header[156]) {
+		case 'L':
+		case 'x':
+			{
+				std::string record(size, '\0');
+
+				if (!read((uint8_t*)record.data(), size) || !read(nullptr, paddedSize - size)) {
+					isFailed = true;
+					return false;
+				}
+
+				if (header[156] == 'L') {
+					overridePath = record.c_str();
+					continue;
+				}
+
+				for (size_t i = 0, recordSize; i < record.size(); i += recordSize) {
+					recordSize = std::strtoull(record.c_str() + i, nullptr, 10);
+					if (!recordSize || i + recordSize > record.size()) break;
+					const size_t keyIndex = record.find(' ', i) + 1;
+					if (record.compare(keyIndex, 5, "path=")) continue;
+					overridePath = record.substr(keyIndex + 5, i + recordSize - keyIndex - 6);
+				}
+			}
+
+			continue;
+		case '\0':
+		case '0':
+		case '7':
+			break;
+		default:
+			overridePath.clear();
+
+			if (!read(nullptr, paddedSize)) {
+				isFailed = true;
+				return false;
+			}
+
+			continue;
+		}
+
+		if (overridePath.size()) {
+			entryPath = std::move(overridePath);
+			overridePath.clear();
+		} else {
+			entryPath.assign((const char*)header, strnlen((const char*)header, 100));
+			if (!std::memcmp(header + 257, "ustar", 5) && header[345]) entryPath = std::string((const char*)header + 345, strnlen((const char*)header + 345, 155)) + "/" + entryPath;
+		}
+
+		if (!set_file_path(entryPath, file) || size > UINT32_MAX) {
+			if (read(nullptr, paddedSize)) continue;
+			isFailed = true;
+			return false;
+		}
+
+		file.data.resize(size);
+		file.error.clear();
+
+		if (!read(file.data.data(), size) || !read(nullptr, paddedSize - size)) {
+			isFailed = true;
+			return false;
+		}
+
+		return true;
+	}
+
+	if (format != FORMAT_TAR || position != data.size()) isFailed = true;
+	return false;
+}
+
+bool ArchiveReader::next_zip_file(File& file) {
+	uint64_t compressedSize, uncompressedSize, localPosition, dataPosition;
+	uint32_t crc;
+	uint16_t flags, method, nameSize, extraSize, commentSize;
+
+	while (remainingEntries) {
+		remainingEntries--;
+
+		if (position + 46 > data.size() || read_little_endian(data.data() + position, 4) != 0x02014B50) {
+			isFailed = true;
+			return false;
+		}
+
+		const uint8_t* const header = data.data() + position;
+		flags = read_little_endian(header + 8, 2);
+		method = read_little_endian(header + 10, 2);
+		crc = read_little_endian(header + 16, 4);
+		compressedSize = read_little_endian(header + 20, 4);
+		uncompressedSize = read_little_endian(header + 24, 4);
+		nameSize = read_little_endian(header + 28, 2);
+		extraSize = read_little_endian(header + 30, 2);
+		commentSize = read_little_endian(header + 32, 2);
+		localPosition = read_little_endian(header + 42, 4);
+
+		if (position + 46 + nameSize + extraSize + commentSize > data.size()) {
+			isFailed = true;
+			return false;
+		}
+
+		for (const uint8_t* extra = header + 46 + nameSize; extra + 4 <= header + 46 + nameSize + extraSize;) {
+			const uint16_t extraId = read_little_endian(extra, 2);
+			const uint16_t extraFieldSize = read_little_endian(extra + 2, 2);
+			const uint8_t* field = extra + 4;
+			extra += 4 + extraFieldSize;
+			if (extraId != 0x0001 || extra > header + 46 + nameSize + extraSize) continue;
+
+			if (uncompressedSize == 0xFFFFFFFF && field + 8 <= extra) {
+				uncompressedSize = read_little_endian(field, 8);
+				field += 8;
+			}
+
+			if (compressedSize == 0xFFFFFFFF && field + 8 <= extra) {
+				compressedSize = read_little_endian(field, 8);
+				field += 8;
+			}
+
+			if (localPosition == 0xFFFFFFFF && field + 8 <= extra) localPosition = read_little_endian(field, 8);
+		}
+
+		const std::string entryPath((const char*)header + 46, nameSize);
+		position += 46 + nameSize + extraSize + commentSize;
+		if (!set_file_path(entryPath, file)) continue;
+		file.data.clear();
+		file.error.clear();
+
+		if (flags & 0x01) {
+			file.error = "Archive entry is encrypted";
+			return true;
+		}
+
+		if (method != 0 && method != 8) {
+			file.error = "Archive entry uses unsupported compression method " + std::to_string(method);
+			return true;
+		}
+
+		if (uncompressedSize > UINT32_MAX) {
+			file.error = "Archive entry is too large";
+			return true;
+		}
+
+		if (localPosition > data.size() || data.size() - localPosition < 30 || read_little_endian(data.data() + localPosition, 4) != 0x04034B50) {
+			file.error = "Archive entry is corrupt";
+			return true;
+		}
+
+		dataPosition = localPosition + 30 + read_little_endian(data.data() + localPosition + 26, 2) + read_little_endian(data.data() + localPosition + 28, 2);
+
+		if (dataPosition > data.size() || compressedSize > data.size() - dataPosition) {
+			file.error = "Archive entry is corrupt";
+			return true;
+		}
+
+		file.data.resize(uncompressedSize);
+
+		if (method == 0) {
+			if (compressedSize == uncompressedSize) {
+				std::memcpy(file.data.data(), data.data() + dataPosition, uncompressedSize);
+			} else {
+				file.error = "Archive entry is corrupt";
+			}
+		} else {
+			inflate.begin(data.data() + dataPosition, compressedSize);
+			if (!inflate.read(file.data.data(), uncompressedSize)) file.error = "Archive entry is corrupt";
+		}
+
+		if (!file.error.size() && update_crc32(0, file.data.data(), file.data.size()) != crc) file.error = "Archive entry failed the CRC check";
+		if (file.error.size()) file.data.clear();
+		return true;
+	}
+
+	return false;
+}
+
+bool ArchiveReader::read(uint8_t* const& buffer, const uint64_t& size) {
+	if (format == FORMAT_GZIP) return inflate.read(buffer, size);
+	if (size > data.size() - position) return false;
+	if (buffer) std::memcpy(buffer, data.data() + position, size);
+	position += size;
+	return true;
+}
+
+bool ArchiveReader::set_file_path(const std::string& entryPath, File& file) const {
+	std::string path = entryPath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	while (!path.compare(0, 2, "./")) path.erase(0, 2);
+	if (!path.size() || path.front() == '/' || path.back() == '/' || path.find(':') != std::string::npos) return false;
+
+	for (size_t i = 0, next; i < path.size(); i = next + 1) {
+		next = path.find('/', i);
+		if (next == std::string::npos) next = path.size();
+		if (next - i == 2 && !path.compare(i, 2, "..")) return false;
+	}
+
+	const size_t nameIndex = path.rfind('/') + 1;
+	file.name = path.substr(nameIndex);
+	if (!filter(file.name)) return false;
+	file.path = path.substr(0, nameIndex);
+	std::replace(file.path.begin(), file.path.end(), '/', PATH_SEPARATOR);
+	return true;
+}
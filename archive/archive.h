@@ -0,0 +1,77 @@
+class ArchiveWriter {
+public:
+
+	ArchiveWriter(const std::string& filePath, const bool& isCompressed);
+
+	bool open();
+	bool add_file(const std::string& filePath, const std::string& data);
+	bool close();
+
+	const std::string filePath;
+
+private:
+
+	static constexpr uint32_t BLOCK_SIZE = 512;
+	static constexpr uint32_t FLUSH_SIZE = 0x100000;
+	static constexpr char PAX_HEADER_NAME[] = "././@PaxHeader";
+
+	void add_directories(const std::string& path);
+	void write_header(const std::string& path, const uint64_t& size, const char& type);
+	void write_padding(const uint64_t& size);
+	void write(const char* const& data, const uint64_t& size);
+	void flush();
+
+	const bool isCompressed;
+	bool isFailed = false;
+	OutputFile file;
+	Deflate deflate;
+	std::string buffer;
+	uint32_t crc = 0;
+	uint64_t dataSize = 0;
+	uint64_t modifiedTime = 0;
+	std::unordered_map<std::string, bool> directories;
+};
+
+class ArchiveReader {
+public:
+
+	struct File {
+		std::string path;
+		std::string name;
+		std::vector<uint8_t> data;
+		std::string error;
+	};
+
+	ArchiveReader(const std::string& filePath, const DirectoryWalker::FileFilter& filter);
+
+	bool open();
+	bool next_file(File& file);
+
+	const std::string filePath;
+	bool isFailed = false;
+
+private:
+
+	enum FORMAT {
+		FORMAT_TAR,
+		FORMAT_GZIP,
+		FORMAT_ZIP
+	};
+
+	static constexpr uint32_t BLOCK_SIZE = 512;
+	static constexpr uint32_t READ_SIZE = 0x40000000;
+
+	bool open_gzip();
+	bool open_zip();
+	bool next_tar_file(File& file);
+	bool next_zip_file(File& file);
+	bool read(uint8_t* const& buffer, const uint64_t& size);
+	bool set_file_path(const std::string& entryPath, File& file) const;
+
+	const DirectoryWalker::FileFilter filter;
+	FORMAT format = FORMAT_TAR;
+	std::vector<uint8_t> data;
+	uint64_t position = 0;
+	uint64_t remainingEntries = 0;
+	Inflate inflate;
+};
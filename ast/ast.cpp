@@ -1,6 +1,13 @@
-#include "..\main.h"
-
-Ast::Ast(const Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs) : bytecode(bytecode), ignoreDebugInfo(ignoreDebugInfo), minimizeDiffs(minimizeDiffs) {}
+#include "../main.h"
+
+Ast::Ast(Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs, const bool& lowMemory, Stats* const& stats, Buffers* const& buffers)
+	: bytecode(bytecode), ignoreDebugInfo(ignoreDebugInfo), minimizeDiffs(minimizeDiffs), lowMemory(lowMemory), stats(stats), buffers(buffers) {
+	if (!buffers) return;
+	statements.swap(buffers->statements);
+	functions.swap(buffers->functions);
+	expressions.swap(buffers->expressions);
+	slotScopes.swap(buffers->slotScopes);
+}
 
 Ast::~Ast() {
 	for (uint32_t i = statements.size(); i--;) {
@@ -11,9 +18,27 @@ Ast::~Ast() {
 		delete functions[i];
 	}
 
+	for (uint32_t i = expressions.size(); i--;) {
+		if (expressions[i]->index != i) expressions[i] = nullptr;
+	}
+
 	for (uint32_t i = expressions.size(); i--;) {
 		delete expressions[i];
 	}
+
+	for (uint32_t i = slotScopes.size(); i--;) {
+		delete slotScopes[i];
+	}
+
+	if (!buffers) return;
+	statements.clear();
+	functions.clear();
+	expressions.clear();
+	slotScopes.clear();
+	statements.swap(buffers->statements);
+	functions.swap(buffers->functions);
+	expressions.swap(buffers->expressions);
+	slotScopes.swap(buffers->slotScopes);
 }
 
 Ast::Function*& Ast::new_function(const Bytecode::Prototype& prototype, const uint32_t& level) {
@@ -21,29 +46,110 @@ Ast::Function*& Ast::new_function(const Bytecode::Prototype& prototype, const ui
 }
 
 Ast::Statement*& Ast::new_statement(const AST_STATEMENT& type) {
-	return statements.emplace_back(new Statement(type));
+	STATS_STATEMENT();
+	Statement*& statement = statements.emplace_back(new Statement(type));
+	statement->index = statements.size() - 1;
+	return statement;
 }
 
 Ast::Expression*& Ast::new_expression(const AST_EXPRESSION& type) {
-	return expressions.emplace_back(new Expression(type));
+	STATS_EXPRESSION();
+	Expression*& expression = expressions.emplace_back(new Expression(type));
+	expression->index = expressions.size() - 1;
+	return expression;
+}
+
+Ast::SlotScopeIndex Ast::new_slot_scope() {
+	slotScopes.emplace_back(new SlotScope);
+	slotScopes.back()->slotScope.index = slotScopes.size() - 1;
+	return slotScopes.back()->slotScope;
+}
+
+void Ast::replace_slot(const ExpressionIndex& slot, Expression* const& expression) {
+	Expression* const slotExpression = expressions[slot.index];
+
+	if (slotExpression->index == slot.index) {
+		slotExpression->index = expressions.size();
+		expressions.emplace_back(slotExpression);
+	}
+
+	expressions[slot.index] = expression;
 }
 
 void Ast::operator()() {
+	TRACE_SCOPE("Ast::operator()");
+	const Binding binding(*this);
 	print_progress_bar();
 	chunk = new_function(*bytecode.main, 0);
 	isFR2Enabled = bytecode.header.version == Bytecode::BC_VERSION_2 && (bytecode.header.flags & Bytecode::BC_F_FR2);
 	prototypeDataLeft = bytecode.prototypesTotalSize;
-	uint32_t functionCounter = 0;
-	build_functions(*chunk, functionCounter);
-	functions.shrink_to_fit();
-	statements.shrink_to_fit();
-	expressions.shrink_to_fit();
+	build_functions(*chunk);
+
+	if (!buffers) {
+		functions.shrink_to_fit();
+		statements.shrink_to_fit();
+		expressions.shrink_to_fit();
+		slotScopes.shrink_to_fit();
+	}
+
+	chunkStatementCount = statements.size();
+	chunkFunctionCount = functions.size();
+	chunkExpressionCount = expressions.size();
+	chunkSlotScopeCount = slotScopes.size();
 	erase_progress_bar();
 }
 
-void Ast::build_functions(Function& function, uint32_t& functionCounter) {
-	function.id = functionCounter;
-	functionCounter++;
+void Ast::build_function(Function& function) {
+	if (function.isBuilt) return;
+	const Binding binding(*this);
+	build_functions(function);
+	if (function.level == 1) builtFunctions.emplace_back(&function);
+}
+
+void Ast::release_functions() {
+	if (!builtFunctions.size()) return;
+	STATS_RELEASE(statements.size() - chunkStatementCount);
+
+	while (statements.size() > chunkStatementCount) {
+		delete statements.back();
+		statements.pop_back();
+	}
+
+	while (functions.size() > chunkFunctionCount) {
+		delete functions.back();
+		functions.pop_back();
+	}
+
+	for (uint32_t i = chunkExpressionCount; i < expressions.size(); i++) {
+		if (expressions[i]->index != i) expressions[i] = nullptr;
+	}
+
+	STATS_RELEASE(expressions.size() - chunkExpressionCount - std::count(expressions.begin() + chunkExpressionCount, expressions.end(), nullptr));
+
+	while (expressions.size() > chunkExpressionCount) {
+		delete expressions.back();
+		expressions.pop_back();
+	}
+
+	while (slotScopes.size() > chunkSlotScopeCount) {
+		delete slotScopes.back();
+		slotScopes.pop_back();
+	}
+
+	std::fill(std::begin(primitiveExpressions), std::end(primitiveExpressions), nullptr);
+	literalExpressions.clear();
+
+	for (uint32_t i = builtFunctions.size(); i--;) {
+		builtFunctions[i]->release();
+		bytecode.release_prototype(builtFunctions[i]->prototype);
+	}
+
+	builtFunctions.clear();
+}
+
+void Ast::build_functions(Function& function) {
+	TRACE_SCOPE_ID("Ast::build_functions", function.id, function.prototype.prototypeSize);
+	STATS_BEGIN_FUNCTION(function);
 	build_instructions(function);
 	function.usedGlobals.shrink_to_fit();
 	if (!function.hasDebugInfo) function.slotScopeCollector.build_upvalue_scopes();
@@ -54,15 +160,35 @@ void Ast::build_functions(Function& function, uint32_t& functionCounter) {
 	build_if_statements(function, function.block, nullptr);
 	clean_up(function);
 	function.block.shrink_to_fit();
+	function.isBuilt = true;
+	STATS_END_FUNCTION();
 	prototypeDataLeft -= function.prototype.prototypeSize;
-	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	if (!lowMemory) print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	uint32_t functionId = function.id + 1;
 
 	for (uint32_t i = function.childFunctions.size(); i--;) {
-		build_functions(*function.childFunctions[i], functionCounter);
+		function.childFunctions[i]->id = functionId;
+		functionId += count_functions(function.childFunctions[i]->prototype);
+		if (!lowMemory) build_functions(*function.childFunctions[i]);
 	}
 }
 
+uint32_t Ast::count_functions(const Bytecode::Prototype& prototype) {
+	uint32_t& functionCount = functionCounts[&prototype];
+	if (functionCount) return functionCount;
+	functionCount = 1;
+
+	for (uint32_t i = prototype.instructions.size(); i--;) {
+		if (prototype.instructions[i].type != Bytecode::BC_OP_FNEW) continue;
+		functionCount += count_functions(*prototype.constants[prototype.constants.size() - 1 - prototype.instructions[i].d].prototype);
+	}
+
+	return functionCount;
+}
+
 void Ast::build_instructions(Function& function) {
+	STATS_PASS(PASS_BUILD_INSTRUCTIONS);
+	TRACE_SCOPE("Ast::build_instructions");
 	std::vector<uint8_t> upvalues;
 	function.block.resize(function.prototype.instructions.size(), nullptr);
 
@@ -124,6 +250,8 @@ void Ast::build_instructions(Function& function) {
 }
 
 void Ast::assign_debug_info(Function& function) {
+	STATS_PASS(PASS_ASSIGN_DEBUG_INFO);
+	TRACE_SCOPE("Ast::assign_debug_info");
 	if (!function.hasDebugInfo) return group_jumps(function);
 	std::vector<uint32_t> activeLocalScopes;
 	function.parameterNames.resize(function.prototype.header.parameters);
@@ -199,11 +327,15 @@ void Ast::assign_debug_info(Function& function) {
 }
 
 void Ast::group_jumps(Function& function) {
+	STATS_PASS(PASS_GROUP_JUMPS);
+	TRACE_SCOPE("Ast::group_jumps");
+	std::vector<Function::Jump> jumps;
+
 	for (uint32_t i = function.block.size(); i--;) {
 		switch (function.block[i]->instruction.type) {
 		case Bytecode::BC_OP_ISTC:
 		case Bytecode::BC_OP_ISFC:
-			function.add_jump(function.block[i]->instruction.id, function.block[i]->instruction.id + 2);
+			jumps.emplace_back(Function::Jump{ .id = function.block[i]->instruction.id, .target = function.block[i]->instruction.id + 2 });
 		case Bytecode::BC_OP_ISLT:
 		case Bytecode::BC_OP_ISGE:
 		case Bytecode::BC_OP_ISLE:
@@ -220,7 +352,7 @@ void Ast::group_jumps(Function& function) {
 		case Bytecode::BC_OP_ISF:
 			function.block[i]->type = AST_STATEMENT_CONDITION;
 			function.block[i]->instruction.target = function.block[i + 1]->instruction.target;
-			function.block.erase(function.block.begin() + i + 1);
+			function.block[i + 1] = nullptr;
 			function.slotScopeCollector.add_jump(function.block[i]->instruction.id + 1, function.block[i]->instruction.target);
 			continue;
 		case Bytecode::BC_OP_UCLO:
@@ -228,11 +360,13 @@ void Ast::group_jumps(Function& function) {
 		case Bytecode::BC_OP_JMP:
 			function.block[i]->type = AST_STATEMENT_GOTO;
 		case Bytecode::BC_OP_LOOP:
-			function.add_jump(function.block[i]->instruction.id, function.block[i]->instruction.target);
+			jumps.emplace_back(Function::Jump{ .id = function.block[i]->instruction.id, .target = function.block[i]->instruction.target });
 			continue;
 		}
 	}
 
+	std::erase(function.block, nullptr);
+	function.add_jumps(jumps);
 	function.labels.shrink_to_fit();
 	uint32_t index;
 
@@ -264,6 +398,7 @@ void Ast::group_jumps(Function& function) {
 			function.remove_jump(function.block[i - 1]->instruction.id, function.block[i - 1]->instruction.target);
 			function.block[i - 1]->type = AST_STATEMENT_CONDITION;
 			function.block[i - 1]->instruction.target = function.block[i]->instruction.target;
+			STATS_ERASE(function.block, i + 1);
 			function.block.erase(function.block.begin() + i);
 			continue;
 		}
@@ -304,45 +439,52 @@ void Ast::group_jumps(Function& function) {
 }
 
 void Ast::build_loops(Function& function) {
-	static const auto build_break_statements = [](std::vector<Statement*>& block, const uint32_t& breakTarget)->void {
+	STATS_PASS(PASS_BUILD_LOOPS);
+	TRACE_SCOPE("Ast::build_loops");
+	static const auto build_break_statements = [](std::vector<StatementIndex>& block, const uint32_t& breakTarget)->void {
 		for (uint32_t i = block.size(); i--;) {
 			if (block[i]->type != AST_STATEMENT_GOTO || block[i]->instruction.target != breakTarget) continue;
 			block[i]->type = AST_STATEMENT_BREAK;
 		}
 	};
 
+	std::vector<StatementIndex> block;
+	block.reserve(function.block.size());
+	const auto build_loop_block = [this, &block](Statement* const& loop, const uint32_t& loopEnd)->void {
+		uint32_t index = block.size();
+		while (index && block[index - 1]->instruction.id < loopEnd) index--;
+		assert(index && block[index - 1]->instruction.id == loopEnd, "Loop has invalid jump target", bytecode.filePath, DEBUG_INFO);
+		loop->block.assign(block.rbegin(), block.rend() - index);
+		block.resize(index);
+	};
+
 	uint32_t targetIndex, breakTarget;
 
-	for (uint32_t i = function.block.size(); i--;) {
+	for (uint32_t i = function.block.size(); i--; block.emplace_back(function.block[i])) {
 		if (function.block[i]->type != AST_STATEMENT_INSTRUCTION) continue;
 
 		switch (function.block[i]->instruction.type) {
 		case Bytecode::BC_OP_ISNEXT:
 		case Bytecode::BC_OP_JMP:
 			function.block[i]->type = AST_STATEMENT_GENERIC_FOR;
-			targetIndex = get_block_index_from_id(function.block, function.block[i]->instruction.target);
-			breakTarget = get_extended_id_from_statement(function.block[targetIndex + 2]);
-			function.block[targetIndex]->instruction.target = function.block[i]->instruction.label;
-			function.block[i]->instruction = function.block[targetIndex]->instruction;
-			function.block[i]->instruction.id = function.block[targetIndex + 1]->instruction.target - 1;
+			build_loop_block(function.block[i], function.block[i]->instruction.target + 1);
+			breakTarget = get_extended_id_from_statement(block[block.size() - 2]);
+			function.block[i]->block.back()->instruction.target = function.block[i]->instruction.label;
+			function.block[i]->instruction = function.block[i]->block.back()->instruction;
+			function.block[i]->instruction.id = block.back()->instruction.target - 1;
 			function.block[i]->instruction.label = function.block[i]->instruction.target;
-			function.block[i]->instruction.target = function.block[targetIndex + 1]->instruction.id + 1;
-			function.block[targetIndex]->type = AST_STATEMENT_EMPTY;
-			function.block[i]->block.reserve(targetIndex - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex + 1);
-			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex + 2);
+			function.block[i]->instruction.target = block.back()->instruction.id + 1;
+			function.block[i]->block.back()->type = AST_STATEMENT_EMPTY;
+			block.pop_back();
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
 			build_break_statements(function.block[i]->block, breakTarget);
 			build_local_scopes(function, function.block[i]->block);
 			continue;
 		case Bytecode::BC_OP_FORI:
 			function.block[i]->type = AST_STATEMENT_NUMERIC_FOR;
-			targetIndex = get_block_index_from_id(function.block, function.block[i]->instruction.target);
-			breakTarget = get_extended_id_from_statement(function.block[targetIndex]);
-			function.block[targetIndex - 1]->type = AST_STATEMENT_EMPTY;
-			function.block[i]->block.reserve(targetIndex - 1 - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
-			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex);
+			build_loop_block(function.block[i], function.block[i]->instruction.target);
+			breakTarget = get_extended_id_from_statement(block.back());
+			function.block[i]->block.back()->type = AST_STATEMENT_EMPTY;
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
 			build_break_statements(function.block[i]->block, breakTarget);
 			build_local_scopes(function, function.block[i]->block);
@@ -352,22 +494,19 @@ void Ast::build_loops(Function& function) {
 			function.remove_jump(function.block[i]->instruction.id, function.block[i]->instruction.target);
 
 			if (function.block[i]->instruction.target == function.block[i]->instruction.id) {
-				assert(i + 1 < function.block.size()
-					&& function.block[i + 1]->type == AST_STATEMENT_GOTO
-					&& function.block[i + 1]->instruction.target <= function.block[i]->instruction.id
-					&& !function.is_valid_label(function.block[i + 1]->instruction.label),
+				assert(block.size()
+					&& block.back()->type == AST_STATEMENT_GOTO
+					&& block.back()->instruction.target <= function.block[i]->instruction.id
+					&& !function.is_valid_label(block.back()->instruction.label),
 					"Invalid goto loop", bytecode.filePath, DEBUG_INFO);
 				function.block[i]->type = AST_STATEMENT_EMPTY;
-				function.block[i + 1]->instruction.type = function.block[i]->instruction.type;
+				block.back()->instruction.type = function.block[i]->instruction.type;
 				continue;
 			}
 
 			function.block[i]->type = AST_STATEMENT_LOOP;
-			targetIndex = get_block_index_from_id(function.block, function.block[i]->instruction.target);
-			breakTarget = get_extended_id_from_statement(function.block[targetIndex]);
-			function.block[i]->block.reserve(targetIndex - 1 - i);
-			function.block[i]->block.insert(function.block[i]->block.begin(), function.block.begin() + i + 1, function.block.begin() + targetIndex);
-			function.block.erase(function.block.begin() + i + 1, function.block.begin() + targetIndex);
+			build_loop_block(function.block[i], function.block[i]->instruction.target);
+			breakTarget = get_extended_id_from_statement(block.back());
 			function.slotScopeCollector.add_loop(function.block[i]->instruction.id, function.block[i]->instruction.target);
 			build_break_statements(function.block[i]->block, breakTarget);
 
@@ -399,49 +538,91 @@ void Ast::build_loops(Function& function) {
 		}
 	}
 
-	function.slotScopeCollector.upvalueInfos.shrink_to_fit();
+	function.block.assign(block.rbegin(), block.rend());
+	function.slotScopeCollector.sort_upvalue_infos();
 	return build_local_scopes(function, function.block);
 }
 
-void Ast::build_local_scopes(Function& function, std::vector<Statement*>& block) {
+void Ast::build_local_scopes(Function& function, std::vector<StatementIndex>& block) {
+	STATS_PASS(PASS_BUILD_LOCAL_SCOPES);
+	TRACE_SCOPE("Ast::build_local_scopes");
 	if (!function.hasDebugInfo) return build_expressions(function, block);
-	uint32_t scopeBeginIndex, scopeEndIndex;
+	std::vector<StatementIndex> scopeBlock, scopes, declarations, pendingStatements;
+	uint32_t localIndex = 0;
+	scopeBlock.reserve(block.size());
 
-	for (uint32_t i = function.locals.size(); i--;) {
-		scopeBeginIndex = get_block_index_from_id(block, function.locals[i].scopeBegin);
-		if (scopeBeginIndex == INVALID_ID) continue;
+	const auto close_scope = [&scopes, &pendingStatements]()->void {
+		std::vector<StatementIndex>& scopeStatements = scopes.back()->block;
+		scopes.pop_back();
+
+		while (scopeStatements.size() && scopeStatements.back()->type == AST_STATEMENT_DECLARATION && scopeStatements.back()->locals->excludeBlock) {
+			pendingStatements.emplace_back(scopeStatements.back());
+			scopeStatements.pop_back();
+		}
+	};
+
+	const auto add_pending_statements = [&scopeBlock, &scopes, &pendingStatements, &close_scope]()->void {
+		while (pendingStatements.size()) {
+			if (scopes.size() && pendingStatements.back()->instruction.id == scopes.back()->locals->scopeEnd + 1) {
+				close_scope();
+				continue;
+			}
 
-		switch (block[scopeBeginIndex]->type) {
+			(scopes.size() ? scopes.back()->block : scopeBlock).emplace_back(pendingStatements.back());
+			pendingStatements.pop_back();
+		}
+	};
+
+	for (uint32_t i = 0; i < block.size(); i++) {
+		pendingStatements.emplace_back(block[i]);
+		add_pending_statements();
+		if (block[i]->instruction.id == INVALID_ID) continue;
+
+		while (localIndex < function.locals.size() && function.locals[localIndex].scopeBegin < block[i]->instruction.id) {
+			localIndex++;
+		}
+
+		if (localIndex == function.locals.size() || function.locals[localIndex].scopeBegin != block[i]->instruction.id) continue;
+
+		switch (block[i]->type) {
 		case AST_STATEMENT_NUMERIC_FOR:
 		case AST_STATEMENT_GENERIC_FOR:
-			block[scopeBeginIndex]->locals = &function.locals[i];
+			block[i]->locals = &function.locals[localIndex];
 			continue;
 		}
 
-		scopeBeginIndex++;
-		block.emplace(block.begin() + scopeBeginIndex, new_statement(AST_STATEMENT_DECLARATION));
-		block[scopeBeginIndex]->locals = &function.locals[i];
-
-		if (function.locals[i].scopeEnd > function.locals[i].scopeBegin) {
-			block[scopeBeginIndex]->instruction.id = function.locals[i].scopeBegin + 1;
-			scopeEndIndex = get_block_index_from_id(block, function.locals[i].scopeEnd + 1);
-			if (scopeEndIndex == INVALID_ID) scopeEndIndex = block.size();
-
-			while (block[scopeEndIndex - 1]->type == AST_STATEMENT_DECLARATION && block[scopeEndIndex - 1]->locals->excludeBlock) {
-				scopeEndIndex--;
+		for (; localIndex < function.locals.size() && function.locals[localIndex].scopeBegin == block[i]->instruction.id; localIndex++) {
+			pendingStatements.emplace_back(new_statement(AST_STATEMENT_DECLARATION));
+			pendingStatements.back()->locals = &function.locals[localIndex];
+			if (function.locals[localIndex].scopeEnd == function.locals[localIndex].scopeBegin) {
+				add_pending_statements();
+				continue;
 			}
 
-			block[scopeBeginIndex]->block.reserve(scopeEndIndex - 1 - scopeBeginIndex);
-			block[scopeBeginIndex]->block.insert(block[scopeBeginIndex]->block.begin(), block.begin() + scopeBeginIndex + 1, block.begin() + scopeEndIndex);
-			block.erase(block.begin() + scopeBeginIndex + 1, block.begin() + scopeEndIndex);
-			build_expressions(function, block[scopeBeginIndex]->block);
+			pendingStatements.back()->instruction.id = function.locals[localIndex].scopeBegin + 1;
+			declarations.emplace_back(pendingStatements.back());
+			add_pending_statements();
+			scopes.emplace_back(declarations.back());
 		}
 	}
 
+	while (scopes.size()) {
+		close_scope();
+		add_pending_statements();
+	}
+
+	block.swap(scopeBlock);
+
+	for (uint32_t i = declarations.size(); i--;) {
+		build_expressions(function, declarations[i]->block);
+	}
+
 	return build_expressions(function, block);
 }
 
-void Ast::build_expressions(Function& function, std::vector<Statement*>& block) {
+void Ast::build_expressions(Function& function, std::vector<StatementIndex>& block) {
+	STATS_PASS(PASS_BUILD_EXPRESSIONS);
+	TRACE_SCOPE("Ast::build_expressions");
 	for (uint32_t i = block.size(); i--;) {
 		switch (block[i]->type) {
 		case AST_STATEMENT_INSTRUCTION:
@@ -581,7 +762,6 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 				break;
 			case Bytecode::BC_OP_KSTR:
 				block[i]->assignment.expressions.back() = new_string(function, block[i]->instruction.d);
-				check_valid_name(block[i]->assignment.expressions.back()->constant);
 				break;
 			case Bytecode::BC_OP_KCDATA:
 				block[i]->assignment.expressions.back() = new_cdata(function, block[i]->instruction.d);
@@ -651,13 +831,13 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 			case Bytecode::BC_OP_GGET:
 				block[i]->assignment.expressions.back() = new_expression(AST_EXPRESSION_VARIABLE);
 				block[i]->assignment.expressions.back()->variable->type = AST_VARIABLE_GLOBAL;
-				block[i]->assignment.expressions.back()->variable->name = function.get_constant(block[i]->instruction.d).string;
+				block[i]->assignment.expressions.back()->variable->name = &function.get_constant(block[i]->instruction.d).string;
 				if (function.hasDebugInfo) function.usedGlobals.emplace_back(&function.get_constant(block[i]->instruction.d).string);
 				break;
 			case Bytecode::BC_OP_GSET:
 				block[i]->assignment.variables.resize(1);
 				block[i]->assignment.variables.back().type = AST_VARIABLE_GLOBAL;
-				block[i]->assignment.variables.back().name = function.get_constant(block[i]->instruction.d).string;
+				block[i]->assignment.variables.back().name = &function.get_constant(block[i]->instruction.d).string;
 				if (function.hasDebugInfo) function.usedGlobals.emplace_back(&function.get_constant(block[i]->instruction.d).string);
 				block[i]->assignment.expressions.back() = new_slot(block[i]->instruction.a);
 				block[i]->assignment.register_slots(block[i]->assignment.expressions.back());
@@ -677,7 +857,6 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 					break;
 				case Bytecode::BC_OP_TGETS:
 					block[i]->assignment.expressions.back()->variable->tableIndex = new_string(function, block[i]->instruction.c);
-					check_valid_name(block[i]->assignment.expressions.back()->variable->tableIndex->constant);
 					break;
 				case Bytecode::BC_OP_TGETB:
 					block[i]->assignment.expressions.back()->variable->tableIndex = new_literal(block[i]->instruction.c);
@@ -699,7 +878,6 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 					break;
 				case Bytecode::BC_OP_TSETS:
 					block[i]->assignment.variables.back().tableIndex = new_string(function, block[i]->instruction.c);
-					check_valid_name(block[i]->assignment.variables.back().tableIndex->constant);
 					break;
 				case Bytecode::BC_OP_TSETB:
 					block[i]->assignment.variables.back().tableIndex = new_literal(block[i]->instruction.c);
@@ -800,6 +978,7 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 				block[i]->instruction.id = block[i - 1]->instruction.id;
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
+				STATS_ERASE(block, i + 1);
 				block.erase(block.begin() + i);
 			}
 
@@ -952,7 +1131,9 @@ void Ast::build_expressions(Function& function, std::vector<Statement*>& block)
 	}
 }
 
-void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
+void Ast::build_slot_scopes(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock) {
+	STATS_PASS(PASS_BUILD_SLOT_SCOPES);
+	TRACE_SCOPE("Ast::build_slot_scopes");
 	const auto build_nil_assignment = [this](const uint8_t& slot)->Statement* const {
 		Statement* const statement = new_statement(AST_STATEMENT_ASSIGNMENT);
 		statement->assignment.expressions.resize(1, new_primitive(0));
@@ -965,10 +1146,10 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	uint32_t id, index, targetLabel, extendedTargetLabel;
 	uint8_t targetSlot;
-	SlotScope** targetSlotScope;
+	SlotScopeIndex targetSlotScope;
 	bool isPossibleCondition;
 	bool hasBoolConstruct;
-	std::vector<std::vector<Statement*>> conditionBlocks;
+	std::vector<std::vector<StatementIndex>> conditionBlocks;
 
 	for (uint32_t i = block.size(); i--;) {
 		switch (block[i]->type) {
@@ -1331,7 +1512,7 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 											&& (!hasBoolConstruct
 												|| j != 2
 												|| conditionBlocks[j].back()->type != AST_STATEMENT_CONDITION)) {
-											(*targetSlotScope)->usages++;
+											targetSlotScope->slotScope->usages++;
 											function.slotScopeCollector.slotInfos[targetSlot].activeSlotScope = targetSlotScope;
 										}
 
@@ -1340,20 +1521,20 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 										if (!function.slotScopeCollector.slotInfos[targetSlot].activeSlotScope || j == conditionBlocks.size() - 1) continue;
 
 										while (function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back() != targetSlotScope) {
-											(*targetSlotScope)->usages += (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->usages + 1;
+											targetSlotScope->slotScope->usages += function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope->usages + 1;
 
-											for (uint32_t k = (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.size(); k--;) {
-												*(*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes[k] = *targetSlotScope;
+											for (uint32_t k = function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope->mergedScopes.size(); k--;) {
+												function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope->mergedScopes[k]->slotScope = targetSlotScope->slotScope;
 											}
 
-											(*targetSlotScope)->mergedScopes.insert((*targetSlotScope)->mergedScopes.begin(), (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.begin(), (*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->mergedScopes.end());
-											(*targetSlotScope)->mergedScopes.emplace_back(&(*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back())->slotScope);
-											*function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back() = *targetSlotScope;
+											targetSlotScope->slotScope->mergedScopes.insert(targetSlotScope->slotScope->mergedScopes.begin(), function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope->mergedScopes.begin(), function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope->mergedScopes.end());
+											targetSlotScope->slotScope->mergedScopes.emplace_back(function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope);
+											function.slotScopeCollector.slotInfos[targetSlot].slotScopes.back()->slotScope = targetSlotScope->slotScope;
 											function.slotScopeCollector.slotInfos[targetSlot].slotScopes.pop_back();
 										}
 
 										function.slotScopeCollector.slotInfos[targetSlot].activeSlotScope = targetSlotScope;
-										function.slotScopeCollector.extend_scope(targetSlot, function.get_scope_begin_from_label(targetLabel, (*targetSlotScope)->scopeEnd));
+										function.slotScopeCollector.extend_scope(targetSlot, function.get_scope_begin_from_label(targetLabel, targetSlotScope->slotScope->scopeEnd));
 										break;
 									}
 
@@ -1400,13 +1581,13 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 		assert(!block[i]->assignment.variables.size()
 			|| block[i]->assignment.variables.front().type != AST_VARIABLE_SLOT
 			|| !block[i]->assignment.variables.front().isMultres
-			|| ((*block[i]->assignment.variables.front().slotScope)->usages == 1
+			|| (block[i]->assignment.variables.front().slotScope->slotScope->usages == 1
 				&& (!function.slotScopeCollector.slotInfos[block[i]->assignment.variables.front().slot].activeSlotScope
-					|| *function.slotScopeCollector.slotInfos[block[i]->assignment.variables.front().slot].activeSlotScope != *block[i]->assignment.variables.front().slotScope)),
+					|| function.slotScopeCollector.slotInfos[block[i]->assignment.variables.front().slot].activeSlotScope->slotScope != block[i]->assignment.variables.front().slotScope->slotScope)),
 			"Multres assignment has invalid number of usages", bytecode.filePath, DEBUG_INFO);
 
 		for (uint8_t j = block[i]->assignment.openSlots.size(); j--;) {
-			function.slotScopeCollector.add_to_scope((*block[i]->assignment.openSlots[j])->variable->slot, (*block[i]->assignment.openSlots[j])->variable->slotScope, id);
+			function.slotScopeCollector.add_to_scope(block[i]->assignment.openSlots[j]->variable->slot, block[i]->assignment.openSlots[j]->variable->slotScope, id);
 		}
 
 		if (block[i]->instruction.id != INVALID_ID) {
@@ -1421,7 +1602,9 @@ void Ast::build_slot_scopes(Function& function, std::vector<Statement*>& block,
 	}
 }
 
-void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
+void Ast::eliminate_slots(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock) {
+	STATS_PASS(PASS_ELIMINATE_SLOTS);
+	TRACE_SCOPE("Ast::eliminate_slots");
 	static bool (* const has_self_reference)(const uint8_t&, Expression* const&) = [](const uint8_t& targetSlot, Expression* const& expression)->bool {
 		switch (expression->type) {
 		case AST_EXPRESSION_FUNCTION:
@@ -1478,11 +1661,10 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 				&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 				&& block[i - 1]->assignment.variables.size() == 1
 				&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
+				&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1
 				&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.expressions[0]->variable->slot) {
-				expression = block[i]->assignment.expressions[0];
-				block[i]->assignment.expressions[0] = block[i]->assignment.expressions[1];
-				block[i]->assignment.expressions[1] = expression;
+				std::swap(block[i]->assignment.expressions[0], block[i]->assignment.expressions[1]);
+				std::swap(block[i]->assignment.openSlots[0], block[i]->assignment.openSlots[1]);
 				block[i]->condition.swapped = true;
 			}
 
@@ -1493,11 +1675,12 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 				switch (block[i - 1]->type) {
 				case AST_STATEMENT_ASSIGNMENT:
 					if (block[i - 1]->assignment.variables.front().slot <= block[i]->assignment.expressions[block[i]->assignment.openSlots.size() - 1]->variable->slot) break;
-					assert(block[i - 1]->assignment.variables.size() == 1 && !(*block[i - 1]->assignment.variables.back().slotScope)->usages, "Invalid expression list assignment", bytecode.filePath, DEBUG_INFO);
+					assert(block[i - 1]->assignment.variables.size() == 1 && !block[i - 1]->assignment.variables.back().slotScope->slotScope->usages, "Invalid expression list assignment", bytecode.filePath, DEBUG_INFO);
 				case AST_STATEMENT_FUNCTION_CALL:
 					block[i]->assignment.expressions.emplace(block[i]->assignment.expressions.begin() + block[i]->assignment.openSlots.size(), block[i - 1]->assignment.expressions.back());
 					block[i]->instruction.label = block[i - 1]->instruction.label;
 					i--;
+					STATS_ERASE(block, i + 1);
 					block.erase(block.begin() + i);
 					continue;
 				}
@@ -1519,13 +1702,14 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 						block[i]->assignment.expressions.back() = block[i - 1]->assignment.expressions.back();
 						block[i]->instruction.label = block[i - 1]->instruction.label;
 						i--;
+						STATS_ERASE(block, i + 1);
 						block.erase(block.begin() + i);
 						break;
 					}
 				}
 
 				for (uint32_t j = block[i]->assignment.openSlots.size(); j--;) {
-					block[i]->assignment.openSlots[j] = &block[i]->assignment.expressions[j];
+					block[i]->assignment.openSlots[j] = block[i]->assignment.expressions[j];
 				}
 
 				break;
@@ -1544,16 +1728,16 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[i - 1]->assignment.variables.size() == 1
 					&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
+					&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1
 					&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->binaryOperation->leftOperand->variable->slot
 					&& get_constant_type(block[i - 1]->assignment.expressions.back()) == NUMBER_CONSTANT
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[i - 2]->assignment.variables.size() == 1
 					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
+					&& block[i - 2]->assignment.variables.back().slotScope->slotScope->usages == 1
 					&& block[i - 2]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->binaryOperation->rightOperand->variable->slot) {
-					block[i]->assignment.openSlots[0] = &block[i]->assignment.expressions.back()->binaryOperation->rightOperand;
-					block[i]->assignment.openSlots[1] = &block[i]->assignment.expressions.back()->binaryOperation->leftOperand;
+					block[i]->assignment.openSlots[0] = block[i]->assignment.expressions.back()->binaryOperation->rightOperand;
+					block[i]->assignment.openSlots[1] = block[i]->assignment.expressions.back()->binaryOperation->leftOperand;
 				}
 
 				break;
@@ -1566,21 +1750,21 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[i - 1]->assignment.variables.size() == 1
 					&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
+					&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1
 					&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.variables.back().tableIndex->variable->slot
 					&& get_constant_type(block[i - 1]->assignment.expressions.back())
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[i - 2]->assignment.variables.size() == 1
 					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
+					&& block[i - 2]->assignment.variables.back().slotScope->slotScope->usages == 1
 					&& block[i - 2]->assignment.variables.back().slot == block[i]->assignment.expressions.back()->variable->slot
 					&& (!get_constant_type(block[i - 2]->assignment.expressions.back())
 						|| get_constant_type(block[i - 1]->assignment.expressions.back()) == NIL_CONSTANT)
 					&& block[i - 3]->assignment.isTableConstructor
 					&& block[i - 3]->assignment.variables.back().slot == block[i]->assignment.variables.back().table->variable->slot
 					&& !block[i - 3]->assignment.expressions.back()->table->multresField) {
-					block[i]->assignment.openSlots[0] = &block[i]->assignment.expressions.back();
-					block[i]->assignment.openSlots[1] = &block[i]->assignment.variables.back().tableIndex;
+					block[i]->assignment.openSlots[0] = block[i]->assignment.expressions.back();
+					block[i]->assignment.openSlots[1] = block[i]->assignment.variables.back().tableIndex;
 				}
 
 				break;
@@ -1591,19 +1775,20 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 
 		if (block[i]->type == AST_STATEMENT_DECLARATION
 			&& block[i]->assignment.openSlots.size() == 1
-			&& (*(*block[i]->assignment.openSlots.back())->variable->slotScope)->usages > 1
+			&& block[i]->assignment.openSlots.back()->variable->slotScope->slotScope->usages > 1
 			&& i
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 			&& block[i - 1]->assignment.variables.size() == 1
 			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
 			&& block[i - 1]->function
 			&& block[i - 1]->function->assignmentSlotIsUpvalue
-			&& block[i - 1]->assignment.variables.back().slot == (*block[i]->assignment.openSlots.back())->variable->slot) {
-			*block[i]->assignment.openSlots.back() = block[i - 1]->assignment.expressions.back();
-			*block[i - 1]->assignment.variables.back().slotScope = *block[i]->assignment.variables.back().slotScope;
+			&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.openSlots.back()->variable->slot) {
+			replace_slot(block[i]->assignment.openSlots.back(), block[i - 1]->assignment.expressions.back());
+			block[i - 1]->assignment.variables.back().slotScope->slotScope = block[i]->assignment.variables.back().slotScope->slotScope;
 			block[i]->instruction.label = block[i - 1]->instruction.label;
 			i--;
 			function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
+			STATS_ERASE(block, i + 1);
 			block.erase(block.begin() + i);
 		} else {
 			for (uint8_t j = block[i]->assignment.openSlots.size();
@@ -1613,12 +1798,12 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 				&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 				&& block[i - 1]->assignment.variables.size() == 1
 				&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1;) {
+				&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1;) {
 				if (j == 1
 					&& block[i]->assignment.isPotentialMethod
 					&& i >= 2
 					&& !function.is_valid_label(block[i - 1]->instruction.label)
-					&& block[i - 1]->assignment.variables.back().slot == (*block[i]->assignment.openSlots.front())->variable->slot
+					&& block[i - 1]->assignment.variables.back().slot == block[i]->assignment.openSlots.front()->variable->slot
 					&& block[i - 1]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
 					&& block[i - 1]->assignment.expressions.back()->variable->type == AST_VARIABLE_TABLE_INDEX
 					&& block[i - 1]->assignment.expressions.back()->variable->table->type == AST_EXPRESSION_VARIABLE
@@ -1628,8 +1813,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					&& block[i - 2]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[i - 2]->assignment.variables.size() == 1
 					&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& (*block[i - 2]->assignment.variables.back().slotScope)->usages == 1
-					&& block[i - 2]->assignment.variables.back().slot == (*block[i]->assignment.openSlots[j])->variable->slot
+					&& block[i - 2]->assignment.variables.back().slotScope->slotScope->usages == 1
+					&& block[i - 2]->assignment.variables.back().slot == block[i]->assignment.openSlots[j]->variable->slot
 					&& block[i - 2]->assignment.expressions.back()->type == AST_EXPRESSION_VARIABLE
 					&& block[i - 2]->assignment.expressions.back()->variable->type == AST_VARIABLE_SLOT
 					&& block[i - 2]->assignment.expressions.back()->variable->slot == block[i - 1]->assignment.expressions.back()->variable->table->variable->slot) {
@@ -1642,37 +1827,37 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					}
 
 					block[i]->assignment.openSlots.erase(block[i]->assignment.openSlots.begin() + j);
-					block[i]->assignment.openSlots.emplace(block[i]->assignment.openSlots.begin(), &block[i - 1]->assignment.expressions.back()->variable->table);
+					block[i]->assignment.openSlots.emplace(block[i]->assignment.openSlots.begin(), block[i - 1]->assignment.expressions.back()->variable->table);
 					function.slotScopeCollector.remove_scope(block[i - 2]->assignment.variables.back().slot, block[i - 2]->assignment.variables.back().slotScope);
 					block[i - 1]->instruction.label = block[i - 2]->instruction.label;
-					(*block[i - 2]->assignment.expressions.back()->variable->slotScope)->usages--;
+					block[i - 2]->assignment.expressions.back()->variable->slotScope->slotScope->usages--;
 					i--;
+					STATS_ERASE(block, i);
 					block.erase(block.begin() + i - 1);
 				}
 
-				if (block[i - 1]->assignment.variables.back().slot != (*block[i]->assignment.openSlots[j])->variable->slot) continue;
-				assert(block[i - 1]->assignment.variables.back().isMultres == (*block[i]->assignment.openSlots[j])->variable->isMultres,
+				if (block[i - 1]->assignment.variables.back().slot != block[i]->assignment.openSlots[j]->variable->slot) continue;
+				assert(block[i - 1]->assignment.variables.back().isMultres == block[i]->assignment.openSlots[j]->variable->isMultres,
 					"Multres type mismatch when trying to eliminate slot", bytecode.filePath, DEBUG_INFO);
-				expression = *block[i]->assignment.openSlots[j];
-				*block[i]->assignment.openSlots[j] = block[i - 1]->assignment.expressions.back();
 
 				if (!j
 					&& block[i]->assignment.allowedConstantType != NUMBER_CONSTANT
-					&& get_constant_type(block[i]->assignment.expressions.back()) > block[i]->assignment.allowedConstantType) {
-					*block[i]->assignment.openSlots[j] = expression;
+					&& get_constant_type(block[i]->assignment.openSlots[j].index == block[i]->assignment.expressions.back().index
+						? block[i - 1]->assignment.expressions.back() : block[i]->assignment.expressions.back()) > block[i]->assignment.allowedConstantType)
 					break;
-				}
 
+				replace_slot(block[i]->assignment.openSlots[j], block[i - 1]->assignment.expressions.back());
 				function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
+				STATS_ERASE(block, i + 1);
 				block.erase(block.begin() + i);
 			}
 		}
 
 		assert(!block[i]->assignment.openSlots.size()
-			|| (*block[i]->assignment.openSlots.back())->type != AST_EXPRESSION_VARIABLE
-			|| !(*block[i]->assignment.openSlots.back())->variable->isMultres,
+			|| block[i]->assignment.openSlots.back()->type != AST_EXPRESSION_VARIABLE
+			|| !block[i]->assignment.openSlots.back()->variable->isMultres,
 			"Unable to eliminate multres slot", bytecode.filePath, DEBUG_INFO);
 
 		switch (block[i]->type) {
@@ -1695,8 +1880,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 					extendedTargetLabel = get_label_from_next_statement(function, blockInfo, true, true);
 					if (!function.is_valid_label(targetLabel) || function.labels[targetLabel].jumpIds.front() > block[i]->instruction.id) break;
 
-					if ((*block[i]->assignment.variables.back().slotScope)->usages >= 2) {
-						if ((*block[i]->assignment.variables.back().slotScope)->scopeBegin >= function.labels[targetLabel].jumpIds.front()
+					if (block[i]->assignment.variables.back().slotScope->slotScope->usages >= 2) {
+						if (block[i]->assignment.variables.back().slotScope->slotScope->scopeBegin >= function.labels[targetLabel].jumpIds.front()
 							|| (extendedTargetLabel != targetLabel
 								&& (function.labels[extendedTargetLabel].target <= block[i]->instruction.id
 									|| function.labels[extendedTargetLabel].target >= function.labels[targetLabel].jumpIds.front()))
@@ -1708,8 +1893,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 						switch (block[index]->type) {
 						case AST_STATEMENT_CONDITION:
 							if (block[index]->assignment.variables.size()) {
-								if ((*block[index]->assignment.variables.back().slotScope)->scopeBegin == block[index]->instruction.id
-									&& *block[index]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope)
+								if (block[index]->assignment.variables.back().slotScope->slotScope->scopeBegin == block[index]->instruction.id
+									&& block[index]->assignment.variables.back().slotScope->slotScope == block[i]->assignment.variables.back().slotScope->slotScope)
 									break;
 							} else if (index
 									&& block[index]->assignment.expressions.size() == 1
@@ -1717,8 +1902,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 									&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
 									&& block[index - 1]->assignment.variables.size() == 1
 									&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-									&& (*block[index - 1]->assignment.variables.back().slotScope)->scopeBegin == block[index - 1]->instruction.id
-									&& *block[index - 1]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope) {
+									&& block[index - 1]->assignment.variables.back().slotScope->slotScope->scopeBegin == block[index - 1]->instruction.id
+									&& block[index - 1]->assignment.variables.back().slotScope->slotScope == block[i]->assignment.variables.back().slotScope->slotScope) {
 								break;
 							}
 
@@ -1727,8 +1912,8 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 						case AST_STATEMENT_ASSIGNMENT:
 							if (block[index]->assignment.variables.size() != 1
 								|| block[index]->assignment.variables.back().type != AST_VARIABLE_SLOT
-								|| (*block[index]->assignment.variables.back().slotScope)->scopeBegin != block[index]->instruction.id
-								|| *block[index]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
+								|| block[index]->assignment.variables.back().slotScope->slotScope->scopeBegin != block[index]->instruction.id
+								|| block[index]->assignment.variables.back().slotScope->slotScope != block[i]->assignment.variables.back().slotScope->slotScope
 								|| (index != i - 4
 									&& (block[index]->assignment.expressions.back()->type != AST_EXPRESSION_CONSTANT
 										|| !get_constant_type(block[index]->assignment.expressions.back()))))
@@ -1753,7 +1938,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 							&& block[i - 2]->assignment.expressions.back()->constant->type == AST_CONSTANT_FALSE
 							&& block[i - 2]->assignment.variables.size() == 1
 							&& block[i - 2]->assignment.variables.back().type == AST_VARIABLE_SLOT
-							&& *block[i - 2]->assignment.variables.back().slotScope == *block[i]->assignment.variables.back().slotScope) {
+							&& block[i - 2]->assignment.variables.back().slotScope->slotScope == block[i]->assignment.variables.back().slotScope->slotScope) {
 							switch (block[i - 3]->type) {
 							case AST_STATEMENT_CONDITION:
 								if (block[i - 3]->assignment.expressions.size() == 2 && block[i - 3]->instruction.target == block[i]->instruction.id) hasBoolConstruct = true;
@@ -1869,7 +2054,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 										|| block[j]->instruction.target > function.labels[targetLabel].target
 										|| (block[j]->instruction.target == function.labels[targetLabel].target
 											? !block[j]->assignment.variables.size()
-												|| *block[j]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
+												|| block[j]->assignment.variables.back().slotScope->slotScope != block[i]->assignment.variables.back().slotScope->slotScope
 												|| has_self_reference(block[i]->assignment.variables.back().slot, block[j]->assignment.expressions.back())
 											: block[j]->assignment.variables.size()))
 										break;
@@ -1879,7 +2064,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 								case AST_STATEMENT_ASSIGNMENT:
 									if (block[j]->assignment.variables.size() != 1
 										|| block[j]->assignment.variables.back().type != AST_VARIABLE_SLOT
-										|| *block[j]->assignment.variables.back().slotScope != *block[i]->assignment.variables.back().slotScope
+										|| block[j]->assignment.variables.back().slotScope->slotScope != block[i]->assignment.variables.back().slotScope->slotScope
 										|| has_self_reference(block[i]->assignment.variables.back().slot, block[j]->assignment.expressions.back())
 										|| j + 1 == targetIndex
 										|| function.is_valid_label(block[j + 1]->instruction.label))
@@ -1893,7 +2078,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 											|| block[j]->assignment.expressions.size() != 1
 											|| block[j]->assignment.expressions.back()->type != AST_EXPRESSION_VARIABLE
 											|| block[j]->assignment.expressions.back()->variable->type != AST_VARIABLE_SLOT
-											|| *block[j]->assignment.expressions.back()->variable->slotScope != *block[i]->assignment.variables.back().slotScope)
+											|| block[j]->assignment.expressions.back()->variable->slotScope->slotScope != block[i]->assignment.variables.back().slotScope->slotScope)
 											break;
 										conditionBuilder.add_node(conditionBuilder.get_node_type(block[j]->instruction.type, block[j]->condition.swapped), block[j - 1]->instruction.label,
 											function.get_label_from_id(block[j]->instruction.target), &block[j - 1]->assignment.expressions);
@@ -1945,7 +2130,7 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 								for (uint32_t j = index; j < i; j++) {
 									switch (block[j]->type) {
 									case AST_STATEMENT_CONDITION:
-										if (block[j]->instruction.target == function.labels[targetLabel].target) (*block[i]->assignment.variables.back().slotScope)->usages--;
+										if (block[j]->instruction.target == function.labels[targetLabel].target) block[i]->assignment.variables.back().slotScope->slotScope->usages--;
 										function.remove_jump(block[j]->instruction.id + 1, block[j]->instruction.target);
 										if (block[j]->assignment.variables.size()) function.remove_jump(block[j]->instruction.id, block[j]->instruction.id + 2);
 										continue;
@@ -1954,19 +2139,20 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 										function.remove_jump(block[j]->instruction.id, block[j]->instruction.target);
 										continue;
 									case AST_STATEMENT_ASSIGNMENT:
-										(*block[i]->assignment.variables.back().slotScope)->usages--;
+										block[i]->assignment.variables.back().slotScope->slotScope->usages--;
 										continue;
 									}
 								}
 
 								block[i]->instruction.label = block[index]->instruction.label;
 								block[i]->assignment.isTableConstructor = false;
+								STATS_ERASE(block, i);
 								block.erase(block.begin() + index, block.begin() + i);
 								i = index;
 							}
 						}
 					} else {
-						if ((*block[i]->assignment.variables.back().slotScope)->usages == 1
+						if (block[i]->assignment.variables.back().slotScope->slotScope->usages == 1
 							&& (i == block.size() - 1
 								|| block[i + 1]->type != AST_STATEMENT_DECLARATION))
 							break;
@@ -1993,13 +2179,22 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 								block[i - 1]->assignment.expressions.back()->table->multresIndex = block[i]->assignment.variables.back().multresIndex;
 								block[i - 1]->assignment.expressions.back()->table->multresField = block[i]->assignment.expressions.back();
 							} else {
-								if (block[i]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_CONSTANT && block[i]->assignment.variables.back().tableIndex->constant->type == AST_CONSTANT_STRING) {
-									for (uint32_t j = block[i - 1]->assignment.expressions.back()->table->constants.fields.size(); j--;) {
-										if (block[i - 1]->assignment.expressions.back()->table->constants.fields[j].key->constant->type != AST_CONSTANT_STRING
-											|| block[i - 1]->assignment.expressions.back()->table->constants.fields[j].key->constant->string != block[i]->assignment.variables.back().tableIndex->constant->string)
+								if (block[i - 1]->assignment.expressions.back()->table->constants.table
+									&& block[i]->assignment.variables.back().tableIndex->type == AST_EXPRESSION_CONSTANT
+									&& block[i]->assignment.variables.back().tableIndex->constant->type == AST_CONSTANT_STRING) {
+									Table& table = *block[i - 1]->assignment.expressions.back()->table;
+
+									for (uint32_t j = table.constants.table->table.size(); j--;) {
+										if (table.constants.table->table[j].key.type != Bytecode::BC_KTAB_STR
+											|| table.constants.table->table[j].key.string != block[i]->assignment.variables.back().tableIndex->constant->string)
 											continue;
-										if (block[i - 1]->assignment.expressions.back()->table->constants.fields[j].value->constant->type == AST_CONSTANT_NIL)
-											block[i - 1]->assignment.expressions.back()->table->constants.fields.erase(block[i - 1]->assignment.expressions.back()->table->constants.fields.begin() + j);
+
+										if (table.constants.table->table[j].value.type == Bytecode::BC_KTAB_NIL && (!table.constants.removedFields.size() || !table.constants.removedFields[j])) {
+											table.constants.removedFields.resize(table.constants.table->table.size(), false);
+											table.constants.removedFields[j] = true;
+											table.constants.fieldCount--;
+										}
+
 										break;
 									}
 								}
@@ -2009,17 +2204,19 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 								block[i - 1]->assignment.expressions.back()->table->fields.back().value = block[i]->assignment.expressions.back();
 							}
 
-							(*block[i - 1]->assignment.variables.back().slotScope)->usages--;
+							block[i - 1]->assignment.variables.back().slotScope->slotScope->usages--;
+							STATS_ERASE(block, i + 1);
 							block.erase(block.begin() + i);
 							i -= 2;
 							break;
 						}
 
-						if (!block[i]->assignment.variables.back().isMultres && (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1) {
+						if (!block[i]->assignment.variables.back().isMultres && block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1) {
 							block[i]->assignment.variables.back().table = block[i - 1]->assignment.expressions.back();
 							function.slotScopeCollector.remove_scope(block[i - 1]->assignment.variables.back().slot, block[i - 1]->assignment.variables.back().slotScope);
 							block[i]->instruction.label = block[i - 1]->instruction.label;
 							i--;
+							STATS_ERASE(block, i + 1);
 							block.erase(block.begin() + i);
 							break;
 						}
@@ -2035,9 +2232,11 @@ void Ast::eliminate_slots(Function& function, std::vector<Statement*>& block, Bl
 	}
 }
 
-void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
+void Ast::eliminate_conditions(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock) {
+	STATS_PASS(PASS_ELIMINATE_CONDITIONS);
+	TRACE_SCOPE("Ast::eliminate_conditions");
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
-	std::vector<Expression*> expressions(1);
+	std::vector<ExpressionIndex> expressions(1);
 	uint32_t index, targetIndex, previousValidIndex, assignmentIndex, targetLabel, extendedTargetLabel;
 	bool hasBoolConstruct, hasEndAssignment;
 
@@ -2346,13 +2545,13 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 				if (!block[j]->assignment.variables.size()) continue;
 				function.remove_jump(block[j]->instruction.id, block[j]->instruction.id + 2);
 			case AST_STATEMENT_ASSIGNMENT:
-				if (*block[j]->assignment.variables.back().slotScope != *block[assignmentIndex]->assignment.variables.back().slotScope) {
-					(*block[assignmentIndex]->assignment.variables.back().slotScope)->usages += (*block[j]->assignment.variables.back().slotScope)->usages;
-					if ((*block[j]->assignment.variables.back().slotScope)->scopeBegin < (*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeBegin)
-						(*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeBegin = (*block[j]->assignment.variables.back().slotScope)->scopeBegin;
-					if ((*block[j]->assignment.variables.back().slotScope)->scopeEnd > (*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeEnd)
-						(*block[assignmentIndex]->assignment.variables.back().slotScope)->scopeEnd = (*block[j]->assignment.variables.back().slotScope)->scopeEnd;
-					*block[j]->assignment.variables.back().slotScope = *block[assignmentIndex]->assignment.variables.back().slotScope;
+				if (block[j]->assignment.variables.back().slotScope->slotScope != block[assignmentIndex]->assignment.variables.back().slotScope->slotScope) {
+					block[assignmentIndex]->assignment.variables.back().slotScope->slotScope->usages += block[j]->assignment.variables.back().slotScope->slotScope->usages;
+					if (block[j]->assignment.variables.back().slotScope->slotScope->scopeBegin < block[assignmentIndex]->assignment.variables.back().slotScope->slotScope->scopeBegin)
+						block[assignmentIndex]->assignment.variables.back().slotScope->slotScope->scopeBegin = block[j]->assignment.variables.back().slotScope->slotScope->scopeBegin;
+					if (block[j]->assignment.variables.back().slotScope->slotScope->scopeEnd > block[assignmentIndex]->assignment.variables.back().slotScope->slotScope->scopeEnd)
+						block[assignmentIndex]->assignment.variables.back().slotScope->slotScope->scopeEnd = block[j]->assignment.variables.back().slotScope->slotScope->scopeEnd;
+					block[j]->assignment.variables.back().slotScope->slotScope = block[assignmentIndex]->assignment.variables.back().slotScope->slotScope;
 					if (block[j]->assignment.variables.back().slotScope != block[assignmentIndex]->assignment.variables.back().slotScope)
 						function.slotScopeCollector.remove_scope(block[j]->assignment.variables.back().slot, block[j]->assignment.variables.back().slotScope);
 				}
@@ -2368,7 +2567,8 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 		block[i] = block[assignmentIndex];
 		block[i]->type = AST_STATEMENT_ASSIGNMENT;
 		block[i]->instruction.label = block[index]->instruction.label;
-		if ((*block[i]->assignment.variables.back().slotScope)->scopeBegin >= block[index]->instruction.id) block[i]->assignment.forwardDeclaration = true;
+		if (block[i]->assignment.variables.back().slotScope->slotScope->scopeBegin >= block[index]->instruction.id) block[i]->assignment.forwardDeclaration = true;
+		STATS_ERASE(block, i);
 		block.erase(block.begin() + index, block.begin() + i);
 		i = index;
 	}
@@ -2453,6 +2653,7 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 				block[i]->instruction.target = function.labels[extendedTargetLabel].target;
 				function.add_jump(block[i]->instruction.id, block[i]->instruction.target);
 				block[i]->instruction.label = block[index]->instruction.label;
+				STATS_ERASE(block, i);
 				block.erase(block.begin() + index, block.begin() + i);
 				i = index;
 			}
@@ -2497,7 +2698,9 @@ void Ast::eliminate_conditions(Function& function, std::vector<Statement*>& bloc
 	return build_multi_assignment(function, block);
 }
 
-void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& block) {
+void Ast::build_multi_assignment(Function& function, std::vector<StatementIndex>& block) {
+	STATS_PASS(PASS_BUILD_MULTI_ASSIGNMENT);
+	TRACE_SCOPE("Ast::build_multi_assignment");
 	bool isMultiAssignment;
 	uint32_t index;
 
@@ -2509,7 +2712,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				isMultiAssignment = true;
 
 				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-					if ((*block[i]->assignment.variables[j].slotScope)->usages == 1
+					if (block[i]->assignment.variables[j].slotScope->slotScope->usages == 1
 						&& !function.is_valid_label(block[i + block[i]->assignment.variables.size() - j]->instruction.label)
 						&& block[i + block[i]->assignment.variables.size() - j]->type == AST_STATEMENT_ASSIGNMENT
 						&& block[i + block[i]->assignment.variables.size() - j]->assignment.variables.size() == 1
@@ -2533,6 +2736,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
 					function.slotScopeCollector.remove_scope(block[i]->assignment.variables[j].slot, block[i]->assignment.variables[j].slotScope);
 					block[i]->assignment.variables[j] = block[i + 1]->assignment.variables.back();
+					STATS_ERASE(block, i + 2);
 					block.erase(block.begin() + i + 1);
 				}
 
@@ -2543,14 +2747,14 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 
 			if (block[i]->type == AST_STATEMENT_FUNCTION_CALL
 				|| (block[i]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& !(*block[i]->assignment.variables.back().slotScope)->usages
+					&& !block[i]->assignment.variables.back().slotScope->slotScope->usages
 					&& !block[i]->assignment.forwardDeclaration)) {
 				while (index
 					&& !function.is_valid_label(block[index]->instruction.label)
 					&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
 					&& block[index - 1]->assignment.variables.size() == 1
 					&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-					&& !(*block[index - 1]->assignment.variables.back().slotScope)->usages
+					&& !block[index - 1]->assignment.variables.back().slotScope->slotScope->usages
 					&& !block[index - 1]->assignment.forwardDeclaration) {
 					index--;
 				}
@@ -2563,7 +2767,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				&& block[index - 1]->type == AST_STATEMENT_ASSIGNMENT
 				&& block[index - 1]->assignment.variables.size() == 1
 				&& block[index - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& (*block[index - 1]->assignment.variables.back().slotScope)->usages == 1
+				&& block[index - 1]->assignment.variables.back().slotScope->slotScope->usages == 1
 				&& block[i + 1]->type == AST_STATEMENT_ASSIGNMENT
 				&& block[i + 1]->assignment.variables.size() == 1
 				&& (block[i + 1]->assignment.variables.back().type != AST_VARIABLE_TABLE_INDEX
@@ -2579,7 +2783,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				if (block[i]->type == AST_STATEMENT_ASSIGNMENT) {
 					switch (block[i]->assignment.variables.back().type) {
 					case AST_VARIABLE_SLOT:
-						if (!(*block[i]->assignment.variables.back().slotScope)->usages && !block[i]->assignment.forwardDeclaration) {
+						if (!block[i]->assignment.variables.back().slotScope->slotScope->usages && !block[i]->assignment.forwardDeclaration) {
 							function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
 							block[i]->assignment.variables.clear();
 						}
@@ -2603,6 +2807,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 					i--;
 					function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
 					block[i + 1]->assignment.expressions.emplace(block[i + 1]->assignment.expressions.begin(), block[i]->assignment.expressions.back());
+					STATS_ERASE(block, i + 1);
 					block.erase(block.begin() + i);
 				}
 
@@ -2616,6 +2821,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 					&& block[i - 1]->assignment.variables.size() == 1,
 					"Unable to eliminate vararg with zero returns", bytecode.filePath, DEBUG_INFO);
 				block[i - 1]->assignment.expressions.emplace_back(block[i]->assignment.expressions.back());
+				STATS_ERASE(block, i + 1);
 				block.erase(block.begin() + i);
 				i--;
 			}
@@ -2630,7 +2836,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 			&& block[i - 1]->assignment.variables.size() == 1
 			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-			&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1
+			&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1
 			&& block[i + 1]->type == AST_STATEMENT_ASSIGNMENT
 			&& block[i + 1]->assignment.variables.size() == 1
 			&& (block[i + 1]->assignment.variables.back().type != AST_VARIABLE_TABLE_INDEX
@@ -2647,7 +2853,9 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 			block[i]->assignment.expressions.emplace(block[i]->assignment.expressions.begin(), block[i - 1]->assignment.expressions.back());
 			block[i]->assignment.variables.emplace(block[i]->assignment.variables.begin(), block[i + 1]->assignment.variables.back());
 			block[i]->instruction.label = block[i - 1]->instruction.label;
+			STATS_ERASE(block, i);
 			block.erase(block.begin() + i - 1);
+			STATS_ERASE(block, i + 1);
 			block.erase(block.begin() + i);
 			i--;
 		}
@@ -2658,7 +2866,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 			&& block[i - 1]->type == AST_STATEMENT_ASSIGNMENT
 			&& block[i - 1]->assignment.variables.size() == 1
 			&& block[i - 1]->assignment.variables.back().type == AST_VARIABLE_SLOT
-			&& (*block[i - 1]->assignment.variables.back().slotScope)->usages == 1;) {
+			&& block[i - 1]->assignment.variables.back().slotScope->slotScope->usages == 1;) {
 			if (block[i]->assignment.variables[j].type != AST_VARIABLE_TABLE_INDEX) continue;
 
 			if (block[i]->assignment.variables[j].tableIndex->type == AST_EXPRESSION_VARIABLE
@@ -2668,6 +2876,7 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				block[i]->assignment.variables[j].tableIndex = block[i - 1]->assignment.expressions.back();
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
+				STATS_ERASE(block, i + 1);
 				block.erase(block.begin() + i);
 				j++;
 				continue;
@@ -2678,13 +2887,14 @@ void Ast::build_multi_assignment(Function& function, std::vector<Statement*>& bl
 				block[i]->assignment.variables[j].table = block[i - 1]->assignment.expressions.back();
 				block[i]->instruction.label = block[i - 1]->instruction.label;
 				i--;
+				STATS_ERASE(block, i + 1);
 				block.erase(block.begin() + i);
 			}
 		}
 	}
 }
 
-void Ast::build_if_statements_from_map(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap) {
+void Ast::build_if_statements_from_map(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap) {
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	uint32_t index;
 
@@ -2707,6 +2917,7 @@ void Ast::build_if_statements_from_map(Function& function, std::vector<Statement
 
 			block[i]->block.reserve(index - i);
 			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			STATS_ERASE(block, index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 
 			if (block[i]->type == AST_STATEMENT_CONDITION
@@ -2717,6 +2928,7 @@ void Ast::build_if_statements_from_map(Function& function, std::vector<Statement
 				block.emplace(block.begin() + i + 1, new_statement(AST_STATEMENT_ELSE));
 				block[i + 1]->block.reserve(index - i);
 				block[i + 1]->block.insert(block[i + 1]->block.begin(), block.begin() + i + 2, block.begin() + index + 2);
+				STATS_ERASE(block, index + 2);
 				block.erase(block.begin() + i + 2, block.begin() + index + 2);
 				function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
 				block[i]->block.back()->type = AST_STATEMENT_EMPTY;
@@ -2742,8 +2954,10 @@ void Ast::build_if_statements_from_map(Function& function, std::vector<Statement
 	}
 }
 
-void Ast::build_if_statements(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock) {
-	const auto build_if_false_statements = [&](std::vector<Statement*>& block, BlockInfo* const& previousBlock)->void {
+void Ast::build_if_statements(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock) {
+	STATS_PASS(PASS_BUILD_IF_STATEMENTS);
+	TRACE_SCOPE("Ast::build_if_statements");
+	const auto build_if_false_statements = [&](std::vector<StatementIndex>& block, BlockInfo* const& previousBlock)->void {
 		BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 		uint32_t index, targetLabel;
 
@@ -2777,13 +2991,38 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 			block[i]->assignment.expressions.emplace_back(new_primitive(1));
 			block[i]->block.reserve(index - i);
 			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			STATS_ERASE(block, index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 		}
 	};
 
-	const auto build_else_statements = [&](std::vector<Statement*>& block, BlockInfo* const& previousBlock)->void {
+	const auto build_else_statements = [&](std::vector<StatementIndex>& block, BlockInfo* const& previousBlock)->void {
+		static const auto get_next_statement_targets = [](Function& function, Statement* const& statement, uint32_t (&targets)[2])->void {
+			targets[0] = statement->instruction.label == INVALID_ID ? INVALID_ID : function.labels[statement->instruction.label].target;
+			targets[1] = INVALID_ID;
+
+			switch (statement->type) {
+			case AST_STATEMENT_EMPTY:
+			case AST_STATEMENT_GOTO:
+			case AST_STATEMENT_BREAK:
+				if (statement->instruction.type == Bytecode::BC_OP_JMP && statement->instruction.target != targets[0]) targets[1] = statement->instruction.target;
+			}
+		};
+
 		BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
-		uint32_t index, targetLabel;
+		const auto is_else_block_end = [&function, &blockInfo](const uint32_t& index, Statement* const& jump)->bool {
+			blockInfo.index = index;
+			uint32_t targetLabel = get_label_from_next_statement(function, blockInfo, false, false);
+			if (targetLabel == INVALID_ID || function.labels[targetLabel].target != jump->instruction.target) targetLabel = get_label_from_next_statement(function, blockInfo, true, false);
+			return targetLabel != INVALID_ID && function.labels[targetLabel].target == jump->instruction.target && is_valid_block(function, blockInfo, jump->instruction.id + 1);
+		};
+
+		uint32_t index, blockEndIndex = block.size();
+		uint32_t targets[2];
+		bool isBlockEnd;
+		//An else block can only end in front of a statement that refers to its target, or at the end of the block.
+		//These statements are indexed by target and stored as offsets from the end of the block, which stay valid while statements in front of them are moved.
+		std::unordered_map<uint32_t, std::vector<uint32_t>> blockEnds;
 
 		for (uint32_t i = block.size(); i--;) {
 			if (block[i]->type != AST_STATEMENT_IF) continue;
@@ -2791,21 +3030,43 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 			if (block[i]->block.size()
 				&& block[i]->block.back()->type == AST_STATEMENT_GOTO
 				&& block[i]->block.back()->instruction.type != Bytecode::BC_OP_LOOP) {
-				targetLabel = INVALID_ID;
+				isBlockEnd = false;
+
+				for (; blockEndIndex > i + 1; blockEndIndex--) {
+					get_next_statement_targets(function, block[blockEndIndex - 1], targets);
+
+					for (uint8_t j = 2; j--;) {
+						if (targets[j] != INVALID_ID) blockEnds[targets[j]].emplace_back(block.size() - blockEndIndex + 1);
+					}
+				}
+
+				const std::unordered_map<uint32_t, std::vector<uint32_t>>::iterator blockEnd = blockEnds.find(block[i]->block.back()->instruction.target);
+
+				for (uint32_t j = blockEnd == blockEnds.end() ? 0 : blockEnd->second.size(); j-- && !isBlockEnd;) {
+					index = block.size() - blockEnd->second[j] - 1;
+					isBlockEnd = is_else_block_end(index, block[i]->block.back());
+				}
 
-				for (index = i; index < block.size(); index++) {
-					blockInfo.index = index;
-					targetLabel = get_label_from_next_statement(function, blockInfo, false, false);
-					if (targetLabel == INVALID_ID || function.labels[targetLabel].target != block[i]->block.back()->instruction.target) targetLabel = get_label_from_next_statement(function, blockInfo, true, false);
-					if (targetLabel == INVALID_ID) continue;
-					if (function.labels[targetLabel].target == block[i]->block.back()->instruction.target && is_valid_block(function, blockInfo, block[i]->block.back()->instruction.id + 1)) break;
-					targetLabel = INVALID_ID;
+				if (!isBlockEnd) {
+					index = block.size() - 1;
+					isBlockEnd = is_else_block_end(index, block[i]->block.back());
 				}
 
-				if (targetLabel != INVALID_ID) {
+				if (isBlockEnd) {
+					for (uint32_t j = i + 1; j <= index; j++) {
+						get_next_statement_targets(function, block[j], targets);
+
+						for (uint8_t k = 2; k--;) {
+							if (targets[k] == INVALID_ID) continue;
+							std::vector<uint32_t>& offsets = blockEnds[targets[k]];
+							while (offsets.size() && offsets.back() >= block.size() - index) offsets.pop_back();
+						}
+					}
+
 					block.emplace(block.begin() + i + 1, new_statement(AST_STATEMENT_ELSE));
 					block[i + 1]->block.reserve(index - i);
 					block[i + 1]->block.insert(block[i + 1]->block.begin(), block.begin() + i + 2, block.begin() + index + 2);
+					STATS_ERASE(block, index + 2);
 					block.erase(block.begin() + i + 2, block.begin() + index + 2);
 					function.remove_jump(block[i]->block.back()->instruction.id, block[i]->block.back()->instruction.target);
 					block[i]->block.back()->type = AST_STATEMENT_EMPTY;
@@ -2909,6 +3170,7 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 			
 			block[i]->block.reserve(index - i);
 			block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + index + 1);
+			STATS_ERASE(block, index + 1);
 			block.erase(block.begin() + i + 1, block.begin() + index + 1);
 			function.remove_jump(block[i]->instruction.id, block[i]->instruction.target);
 			blockInfo.index = i;
@@ -2931,16 +3193,18 @@ void Ast::build_if_statements(Function& function, std::vector<Statement*>& block
 }
 
 void Ast::clean_up(Function& function) {
+	STATS_PASS(PASS_CLEAN_UP);
+	TRACE_SCOPE("Ast::clean_up");
 	if (function.hasDebugInfo) {
 		for (uint32_t i = function.parameterNames.size(); i--;) {
-			(*function.slotScopeCollector.slotInfos[i].activeSlotScope)->name = function.parameterNames[i];
+			function.slotScopeCollector.slotInfos[i].activeSlotScope->slotScope->name = function.parameterNames[i];
 		}
 	} else {
 		function.parameterNames.resize(function.prototype.header.parameters);
 
 		for (uint32_t i = function.parameterNames.size(); i--;) {
 			function.parameterNames[i] = "arg_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(i);
-			(*function.slotScopeCollector.slotInfos[i].activeSlotScope)->name = function.parameterNames[i];
+			function.slotScopeCollector.slotInfos[i].activeSlotScope->slotScope->name = function.parameterNames[i];
 		}
 	}
 
@@ -2954,11 +3218,11 @@ void Ast::clean_up(Function& function) {
 	}
 }
 
-void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock) {
+void Ast::clean_up_block(Function& function, std::vector<StatementIndex>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock) {
 	//TODO
 	BlockInfo blockInfo = { .block = block, .previousBlock = previousBlock };
 	std::vector<Variable*> declarations;
-	Statement** declarationTarget;
+	StatementIndex* declarationTarget;
 
 	for (uint32_t i = 0; i < block.size(); i++) {
 		switch (block[i]->type) {
@@ -2978,11 +3242,11 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 			if (function.hasDebugInfo) {
 				for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-					(*block[i]->assignment.variables[j].slotScope)->name = block[i]->locals->names[j];
+					block[i]->assignment.variables[j].slotScope->slotScope->name = block[i]->locals->names[j];
 				}
 			} else {
 				for (uint8_t j = 0; j < block[i]->assignment.variables.size(); j++) {
-					(*block[i]->assignment.variables[j].slotScope)->name = "iter_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(iteratorCounter);
+					block[i]->assignment.variables[j].slotScope->slotScope->name = "iter_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(iteratorCounter);
 					iteratorCounter++;
 				}
 			}
@@ -2990,7 +3254,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, nullptr);
 			continue;
 		case AST_STATEMENT_LOOP:
-			for (std::vector<Statement*>* currentBlock = &block[i]->block; currentBlock->size(); currentBlock = &currentBlock->back()->block) {
+			for (std::vector<StatementIndex>* currentBlock = &block[i]->block; currentBlock->size(); currentBlock = &currentBlock->back()->block) {
 				if (currentBlock->back()->type == AST_STATEMENT_DECLARATION) continue;
 				if (currentBlock->back()->type != AST_STATEMENT_GOTO
 					|| currentBlock->back()->instruction.target != block[i]->instruction.id
@@ -3054,6 +3318,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 									block[i]->assignment.expressions.resize(1, expression);
 								}
 
+								STATS_ERASE(block, i);
 								block.erase(block.begin() + i - 1);
 							}
 
@@ -3132,7 +3397,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			}
 
 			for (uint8_t j = block[i]->assignment.variables.size(); j--;) {
-				(*block[i]->assignment.variables[j].slotScope)->name = block[i]->locals->names[j];
+				block[i]->assignment.variables[j].slotScope->slotScope->name = block[i]->locals->names[j];
 			}
 
 			clean_up_block(function, block[i]->block, variableCounter, iteratorCounter, nullptr);
@@ -3140,12 +3405,13 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 		case AST_STATEMENT_ASSIGNMENT:
 			if (block[i]->assignment.variables.size() == 1
 				&& block[i]->assignment.variables.back().type == AST_VARIABLE_SLOT
-				&& !(*block[i]->assignment.variables.back().slotScope)->usages
+				&& !block[i]->assignment.variables.back().slotScope->slotScope->usages
 				&& block[i]->assignment.expressions.size() == 1
 				&& block[i]->assignment.expressions.back()->type == AST_EXPRESSION_TABLE
 				&& block[i]->assignment.expressions.back()->table->fields.size() == 1
-				&& !block[i]->assignment.expressions.back()->table->constants.list.size()
-				&& !block[i]->assignment.expressions.back()->table->constants.fields.size()
+				&& (!block[i]->assignment.expressions.back()->table->constants.table
+					|| (!block[i]->assignment.expressions.back()->table->constants.table->array.size()
+						&& !block[i]->assignment.expressions.back()->table->constants.fieldCount))
 				&& !block[i]->assignment.expressions.back()->table->multresField) {
 				function.slotScopeCollector.remove_scope(block[i]->assignment.variables.back().slot, block[i]->assignment.variables.back().slotScope);
 				block[i]->assignment.variables.back().type = AST_VARIABLE_TABLE_INDEX;
@@ -3157,13 +3423,13 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 			}
 
 			for (uint32_t j = 0; j < block[i]->assignment.variables.size(); j++) {
-				if (block[i]->assignment.variables[j].type != AST_VARIABLE_SLOT || (*block[i]->assignment.variables[j].slotScope)->name.size()) {
+				if (block[i]->assignment.variables[j].type != AST_VARIABLE_SLOT || block[i]->assignment.variables[j].slotScope->slotScope->name.size()) {
 					block[i]->assignment.forwardDeclaration = true;
 					continue;
 				}
 
 				declarations.emplace_back(&block[i]->assignment.variables[j]);
-				(*block[i]->assignment.variables[j].slotScope)->name = "var_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(variableCounter);
+				block[i]->assignment.variables[j].slotScope->slotScope->name = "var_" + std::to_string(minimizeDiffs ? function.level : function.id) + "_" + std::to_string(variableCounter);
 				variableCounter++;
 			}
 
@@ -3181,7 +3447,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 						switch (currentBlockInfo->block[currentBlockInfo->index]->type) {
 						case AST_STATEMENT_IF:
 							if (currentBlockInfo->block[currentBlockInfo->index + 1]->type == AST_STATEMENT_ELSE) {
-								if ((*declarations[j]->slotScope)->scopeEnd <= currentBlockInfo->block[currentBlockInfo->index]->block.back()->instruction.id) break;
+								if (declarations[j]->slotScope->slotScope->scopeEnd <= currentBlockInfo->block[currentBlockInfo->index]->block.back()->instruction.id) break;
 								declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - 1];
 								block[i]->assignment.forwardDeclaration = true;
 								continue;
@@ -3192,13 +3458,13 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 							case AST_STATEMENT_GOTO:
 							case AST_STATEMENT_BREAK:
 								if (currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.type == Bytecode::BC_OP_JMP) {
-									if ((*declarations[j]->slotScope)->scopeEnd < currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.id) break;
+									if (declarations[j]->slotScope->slotScope->scopeEnd < currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.id) break;
 									declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - (currentBlockInfo->block[currentBlockInfo->index]->type == AST_STATEMENT_ELSE ? 2 : 1)];
 									block[i]->assignment.forwardDeclaration = true;
 									continue;
 								}
 							default:
-								if ((*declarations[j]->slotScope)->scopeEnd < function.labels[currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.label].target) break;
+								if (declarations[j]->slotScope->slotScope->scopeEnd < function.labels[currentBlockInfo->block[currentBlockInfo->index + 1]->instruction.label].target) break;
 								declarationTarget = &currentBlockInfo->block[currentBlockInfo->index - (currentBlockInfo->block[currentBlockInfo->index]->type == AST_STATEMENT_ELSE ? 2 : 1)];
 								block[i]->assignment.forwardDeclaration = true;
 								continue;
@@ -3213,7 +3479,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 					if (!*declarationTarget) {
 						*declarationTarget = new_statement(AST_STATEMENT_DECLARATION);
 						(*declarationTarget)->assignment.forwardDeclaration = true;
-						(*declarationTarget)->instruction.target = (*declarations[j]->slotScope)->scopeBegin;
+						(*declarationTarget)->instruction.target = declarations[j]->slotScope->slotScope->scopeBegin;
 					}
 
 					(*declarationTarget)->assignment.variables.emplace_back(*declarations[j]);
@@ -3234,6 +3500,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 				if (!block[i - 1]) {
 					i--;
+					STATS_ERASE(block, i + 1);
 					block.erase(block.begin() + i);
 				}
 
@@ -3282,6 +3549,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 				continue;
 			}
 
+			STATS_ERASE(block, blockInfo.index);
 			block.erase(block.begin() + blockInfo.index - 1);
 			i--;
 			continue;
@@ -3297,6 +3565,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 
 		switch (block[i]->type) {
 		case AST_STATEMENT_EMPTY:
+			STATS_ERASE(block, i + 1);
 			block.erase(block.begin() + i);
 			i--;
 			continue;
@@ -3324,6 +3593,7 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 					j++;
 					block[i]->block.reserve(j - 1 - i);
 					block[i]->block.insert(block[i]->block.begin(), block.begin() + i + 1, block.begin() + j);
+					STATS_ERASE(block, j);
 					block.erase(block.begin() + i + 1, block.begin() + j);
 
 					if (block[i]->block.size() && block[i]->block.back()->type == AST_STATEMENT_DO) {
@@ -3359,12 +3629,26 @@ void Ast::clean_up_block(Function& function, std::vector<Statement*>& block, uin
 	}
 }
 
-uint32_t Ast::get_block_index_from_id(const std::vector<Statement*>& block, const uint32_t& id) {
-	for (uint32_t i = block.size(); i-- && (block[i]->instruction.id == INVALID_ID || block[i]->instruction.id >= id);) {
-		if (block[i]->instruction.id == id) return i;
+uint32_t Ast::get_block_index_from_id(const std::vector<StatementIndex>& block, const uint32_t& id) {
+	uint32_t blockBegin = 0;
+	uint32_t blockEnd = block.size();
+	uint32_t index = INVALID_ID;
+	uint32_t middle, i;
+
+	while (blockBegin < blockEnd) {
+		middle = blockBegin + (blockEnd - blockBegin) / 2;
+		for (i = middle; i > blockBegin && block[i]->instruction.id == INVALID_ID; i--);
+
+		if (block[i]->instruction.id == INVALID_ID || block[i]->instruction.id < id) {
+			blockBegin = middle + 1;
+			continue;
+		}
+
+		index = i;
+		blockEnd = i;
 	}
 
-	return INVALID_ID;
+	return index != INVALID_ID && block[index]->instruction.id == id ? index : INVALID_ID;
 }
 
 uint32_t Ast::get_extended_id_from_statement(Statement* const& statement) {
@@ -3408,19 +3692,19 @@ bool Ast::is_valid_block(Function& function, const BlockInfo& blockInfo, const u
 	return blockEnd == INVALID_ID ? true : (blockEnd > blockBegin ? function.is_valid_block_range(blockBegin, blockEnd - 1, false) : true);
 }
 
-void Ast::check_valid_name(Constant* const& constant) {
+bool Ast::is_valid_name(const std::string& string) {
 	static const std::string KEYWORDS[] = {
 		"and", "break", "do", "else", "elseif", "end", "false",
 		"for", "function", "if", "in", "local", "nil", "not",
 		"or", "repeat", "return", "then", "true", "until", "while"
 	};
 
-	if (!constant->string.size() || constant->string.front() < 'A') return;
+	if (!string.size() || string.front() < 'A') return false;
 
-	for (uint32_t i = constant->string.size(); i--;) {
-		if (constant->string[i] < '0') return;
+	for (uint32_t i = string.size(); i--;) {
+		if (string[i] < '0') return false;
 
-		switch (constant->string[i]) {
+		switch (string[i]) {
 		case ':':
 		case ';':
 		case '<':
@@ -3438,22 +3722,36 @@ void Ast::check_valid_name(Constant* const& constant) {
 		case '}':
 		case '~':
 		case '\x7F':
-			return;
+			return false;
 		}
 	}
 
 	for (uint8_t i = sizeof(KEYWORDS) / sizeof(std::string); i--;) {
-		if (constant->string == KEYWORDS[i]) return;
+		if (string == KEYWORDS[i]) return false;
 	}
 
-	constant->isName = true;
+	return true;
+}
+
+void Ast::check_valid_name(Constant* const& constant) {
+	if (is_valid_name(constant->string)) constant->isName = true;
+}
+
+bool Ast::is_special_number(const double& number, const bool& isCdata) {
+	const uint64_t rawDouble = std::bit_cast<uint64_t>(number);
+
+	if ((rawDouble & DOUBLE_EXPONENT) != DOUBLE_SPECIAL) {
+		assert(rawDouble != DOUBLE_NEGATIVE_ZERO || isCdata, "Number constant is negative zero", bytecode.filePath, DEBUG_INFO);
+		return false;
+	}
+
+	assert(!(rawDouble & DOUBLE_FRACTION), "Number constant is NaN", bytecode.filePath, DEBUG_INFO);
+	return true;
 }
 
 void Ast::check_special_number(Expression* const& expression, const bool& isCdata) {
+	if (!is_special_number(expression->constant->number, isCdata) || isCdata) return;
 	const uint64_t rawDouble = std::bit_cast<uint64_t>(expression->constant->number);
-	if ((rawDouble & DOUBLE_EXPONENT) != DOUBLE_SPECIAL) return assert(rawDouble != DOUBLE_NEGATIVE_ZERO || isCdata, "Number constant is negative zero", bytecode.filePath, DEBUG_INFO);
-	assert(!(rawDouble & DOUBLE_FRACTION), "Number constant is NaN", bytecode.filePath, DEBUG_INFO);
-	if (isCdata) return;
 	expression->set_type(AST_EXPRESSION_BINARY_OPERATION);
 	expression->binaryOperation->type = AST_BINARY_DIVISION;
 	expression->binaryOperation->leftOperand = new_expression(AST_EXPRESSION_CONSTANT);
@@ -3554,20 +3852,25 @@ Ast::Expression* Ast::new_slot(const uint8_t& slot) {
 }
 
 Ast::Expression* Ast::new_literal(const uint8_t& literal) {
-	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
+	Expression*& expression = literalExpressions[literal];
+	if (expression) return expression;
+	expression = new_expression(AST_EXPRESSION_CONSTANT);
 	expression->constant->type = AST_CONSTANT_NUMBER;
 	expression->constant->number = literal;
 	return expression;
 }
 
 Ast::Expression* Ast::new_signed_literal(const uint16_t& signedLiteral) {
-	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
+	Expression*& expression = literalExpressions[std::bit_cast<int16_t>(signedLiteral)];
+	if (expression) return expression;
+	expression = new_expression(AST_EXPRESSION_CONSTANT);
 	expression->constant->type = AST_CONSTANT_NUMBER;
 	expression->constant->number = std::bit_cast<int16_t>(signedLiteral);
 	return expression;
 }
 
 Ast::Expression* Ast::new_primitive(const uint8_t& primitive) {
+	if (primitive < std::size(primitiveExpressions) && primitiveExpressions[primitive]) return primitiveExpressions[primitive];
 	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
 
 	switch (primitive) {
@@ -3584,11 +3887,15 @@ Ast::Expression* Ast::new_primitive(const uint8_t& primitive) {
 		throw nullptr;
 	}
 
+	primitiveExpressions[primitive] = expression;
 	return expression;
 }
 
-Ast::Expression* Ast::new_number(const Function& function, const uint16_t& index) {
-	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
+Ast::Expression* Ast::new_number(Function& function, const uint16_t& index) {
+	if (!function.numberExpressions.size()) function.numberExpressions.resize(function.prototype.numberConstants.size(), nullptr);
+	Expression*& expression = function.numberExpressions[index];
+	if (expression) return expression;
+	expression = new_expression(AST_EXPRESSION_CONSTANT);
 	expression->constant->type = AST_CONSTANT_NUMBER;
 
 	switch (function.get_number_constant(index).type) {
@@ -3604,112 +3911,34 @@ Ast::Expression* Ast::new_number(const Function& function, const uint16_t& index
 	return expression;
 }
 
-Ast::Expression* Ast::new_string(const Function& function, const uint16_t& index) {
-	Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
+Ast::Expression* Ast::new_string(Function& function, const uint16_t& index) {
+	if (!function.stringExpressions.size()) function.stringExpressions.resize(function.prototype.constants.size(), nullptr);
+	Expression*& expression = function.stringExpressions[index];
+	if (expression) return expression;
+	expression = new_expression(AST_EXPRESSION_CONSTANT);
 	expression->constant->type = AST_CONSTANT_STRING;
 	expression->constant->string = function.get_constant(index).string;
+	check_valid_name(expression->constant);
 	return expression;
 }
 
 Ast::Expression* Ast::new_table(const Function& function, const uint16_t& index) {
-	const auto new_table_constant = [this](const Bytecode::TableConstant& constant)->Expression* {
-		Expression* const expression = new_expression(AST_EXPRESSION_CONSTANT);
-
-		switch (constant.type) {
-		case Bytecode::BC_KTAB_NIL:
-			expression->constant->type = AST_CONSTANT_NIL;
-			break;
-		case Bytecode::BC_KTAB_FALSE:
-			expression->constant->type = AST_CONSTANT_FALSE;
-			break;
-		case Bytecode::BC_KTAB_TRUE:
-			expression->constant->type = AST_CONSTANT_TRUE;
-			break;
-		case Bytecode::BC_KTAB_INT:
-			expression->constant->type = AST_CONSTANT_NUMBER;
-			expression->constant->number = std::bit_cast<int32_t>(constant.integer);
-			break;
-		case Bytecode::BC_KTAB_NUM:
-			expression->constant->type = AST_CONSTANT_NUMBER;
-			expression->constant->number = std::bit_cast<double>(constant.number);
-			check_special_number(expression);
-			break;
-		case Bytecode::BC_KTAB_STR:
-			expression->constant->type = AST_CONSTANT_STRING;
-			expression->constant->string = constant.string;
-			break;
-		}
-
-		return expression;
+	const auto check_table_constant = [this](const Bytecode::TableConstant& constant)->void {
+		if (constant.type == Bytecode::BC_KTAB_NUM) is_special_number(std::bit_cast<double>(constant.number));
 	};
 
 	Expression* const expression = new_expression(AST_EXPRESSION_TABLE);
-	expression->table->constants.list.resize(function.get_constant(index).array.size(), nullptr);
+	expression->table->constants.table = &function.get_constant(index);
+	expression->table->constants.fieldCount = expression->table->constants.table->table.size();
 
-	for (uint32_t i = expression->table->constants.list.size(); i--;) {
-		expression->table->constants.list[i] = new_table_constant(function.get_constant(index).array[i]);
+	for (uint32_t i = expression->table->constants.table->array.size(); i--;) {
+		check_table_constant(expression->table->constants.table->array[i]);
 	}
 
-	if (minimizeDiffs) {
-		uint32_t position;
-		Expression* key;
-		Expression** value;
-		Table::Field falseField, trueField;
-		std::vector<Table::Field> numberFields, stringFields;
-
-		for (uint32_t i = function.get_constant(index).table.size(); i--;) {
-			key = new_table_constant(function.get_constant(index).table[i].key);
-
-			switch (key->constant->type) {
-			case AST_CONSTANT_FALSE:
-				falseField.key = key;
-				value = &falseField.value;
-				break;
-			case AST_CONSTANT_TRUE:
-				trueField.key = key;
-				value = &trueField.value;
-				break;
-			case AST_CONSTANT_NUMBER:
-				position = numberFields.size();
-
-				while (position && numberFields[position - 1].key->constant->number > key->constant->number) {
-					position--;
-				}
-
-				numberFields.emplace(numberFields.begin() + position, Table::Field{ .key = key });
-				value = &numberFields[position].value;
-				break;
-			case AST_CONSTANT_STRING:
-				check_valid_name(key->constant);
-				position = stringFields.size();
-
-				while (position && stringFields[position - 1].key->constant->string.compare(key->constant->string) > 0) {
-					position--;
-				}
-
-				stringFields.emplace(stringFields.begin() + position, Table::Field{ .key = key });
-				value = &stringFields[position].value;
-				break;
-			default:
-				throw nullptr;
-			}
-
-			*value = new_table_constant(function.get_constant(index).table[i].value);
-		}
-
-		if (falseField.key) expression->table->constants.fields.emplace_back(falseField);
-		if (trueField.key) expression->table->constants.fields.emplace_back(trueField);
-		expression->table->constants.fields.reserve(expression->table->constants.fields.size() + numberFields.size() + stringFields.size());
-		expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), numberFields.begin(), numberFields.begin() + numberFields.size());
-		expression->table->constants.fields.insert(expression->table->constants.fields.begin() + expression->table->constants.fields.size(), stringFields.begin(), stringFields.begin() + stringFields.size());
-	} else {
-		expression->table->constants.fields.resize(function.get_constant(index).table.size());
-
-		for (uint32_t i = expression->table->constants.fields.size(); i--;) {
-			expression->table->constants.fields[i].key = new_table_constant(function.get_constant(index).table[i].key);
-			if (expression->table->constants.fields[i].key->constant->type == AST_CONSTANT_STRING) check_valid_name(expression->table->constants.fields[i].key->constant);
-			expression->table->constants.fields[i].value = new_table_constant(function.get_constant(index).table[i].value);
-		}
+	for (uint32_t i = expression->table->constants.table->table.size(); i--;) {
+		if (minimizeDiffs && expression->table->constants.table->table[i].key.type == Bytecode::BC_KTAB_NIL) throw nullptr;
+		check_table_constant(expression->table->constants.table->table[i].key);
+		check_table_constant(expression->table->constants.table->table[i].value);
 	}
 
 	return expression;
@@ -3,18 +3,18 @@ private:
 
 	static constexpr uint32_t INVALID_ID = -1;
 
-	enum CONSTANT_TYPE {
+	enum CONSTANT_TYPE : uint8_t {
 		INVALID_CONSTANT,
 		NIL_CONSTANT,
 		BOOL_CONSTANT,
 		NUMBER_CONSTANT
 	};
 
-	struct Local;
-	struct SlotScope;
 	struct ConditionBuilder;
 
 public:
+	struct Local;
+	struct SlotScope;
 	struct Expression;
 	struct Constant;
 	struct Variable;
@@ -24,67 +24,143 @@ public:
 	struct UnaryOperation;
 	struct Statement;
 	struct Function;
+
+	// Nodes link to each other by index into the pools of the Ast bound to the current thread.
+	template <typename T>
+	struct NodeIndex {
+		NodeIndex() = default;
+		NodeIndex(T* const& node) : index(node ? node->index : INVALID_ID) {}
+
+		T* operator->() const {
+			return pool()[index];
+		}
+
+		T& operator*() const {
+			return *pool()[index];
+		}
+
+		operator T*() const {
+			return index == INVALID_ID ? nullptr : pool()[index];
+		}
+
+		static std::vector<T*>& pool() {
+			if constexpr (std::is_same_v<T, Statement>) {
+				return boundAst->statements;
+			} else if constexpr (std::is_same_v<T, Expression>) {
+				return boundAst->expressions;
+			} else {
+				return boundAst->slotScopes;
+			}
+		}
+
+		uint32_t index = INVALID_ID;
+	};
+
+	typedef NodeIndex<Statement> StatementIndex;
+	typedef NodeIndex<Expression> ExpressionIndex;
+	typedef NodeIndex<SlotScope> SlotScopeIndex;
+
+	struct Binding {
+		Binding(Ast& ast) : previousAst(boundAst) {
+			boundAst = &ast;
+		}
+
+		~Binding() {
+			boundAst = previousAst;
+		}
+
+		Ast* const previousAst;
+	};
+
 	#include "building_blocks.h"
 	#include "function.h"
 
-	Ast(const Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs);
+	struct Buffers {
+		std::vector<Statement*> statements;
+		std::vector<Function*> functions;
+		std::vector<Expression*> expressions;
+		std::vector<SlotScope*> slotScopes;
+	};
+
+	Ast(Bytecode& bytecode, const bool& ignoreDebugInfo, const bool& minimizeDiffs, const bool& lowMemory, Stats* const& stats, Buffers* const& buffers = nullptr);
 	~Ast();
 
 	void operator()();
+	void build_function(Function& function);
+	void release_functions();
+	static bool is_valid_name(const std::string& string);
 
 	Function* chunk = nullptr;
 
 private:
 
-	#include "conditionBuilder.h";
+	#include "conditionBuilder.h"
 
 	struct BlockInfo {
 		uint32_t index = INVALID_ID;
-		std::vector<Statement*>& block;
+		std::vector<StatementIndex>& block;
 		BlockInfo* const previousBlock;
 	};
 
 	Function*& new_function(const Bytecode::Prototype& prototype, const uint32_t& level);
 	Statement*& new_statement(const AST_STATEMENT& type);
 	Expression*& new_expression(const AST_EXPRESSION& type);
-	void build_functions(Function& function, uint32_t& functionCounter);
+	SlotScopeIndex new_slot_scope();
+	void replace_slot(const ExpressionIndex& slot, Expression* const& expression);
+	void build_functions(Function& function);
+	uint32_t count_functions(const Bytecode::Prototype& prototype);
 	void build_instructions(Function& function);
 	void assign_debug_info(Function& function);
 	void group_jumps(Function& function);
 	void build_loops(Function& function);
-	void build_local_scopes(Function& function, std::vector<Statement*>& block);
-	void build_expressions(Function& function, std::vector<Statement*>& block);
-	void build_slot_scopes(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
-	void eliminate_slots(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
-	void eliminate_conditions(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
-	void build_multi_assignment(Function& function, std::vector<Statement*>& block);
-	void build_if_statements_from_map(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap);
-	void build_if_statements(Function& function, std::vector<Statement*>& block, BlockInfo* const& previousBlock);
+	void build_local_scopes(Function& function, std::vector<StatementIndex>& block);
+	void build_expressions(Function& function, std::vector<StatementIndex>& block);
+	void build_slot_scopes(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock);
+	void eliminate_slots(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock);
+	void eliminate_conditions(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock);
+	void build_multi_assignment(Function& function, std::vector<StatementIndex>& block);
+	void build_if_statements_from_map(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock, std::unordered_map<Statement*, uint32_t>& offsetMap);
+	void build_if_statements(Function& function, std::vector<StatementIndex>& block, BlockInfo* const& previousBlock);
 	void clean_up(Function& function);
-	void clean_up_block(Function& function, std::vector<Statement*>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock);
+	void clean_up_block(Function& function, std::vector<StatementIndex>& block, uint32_t& variableCounter, uint32_t& iteratorCounter, BlockInfo* const& previousBlock);
 	Expression* new_slot(const uint8_t& slot);
 	Expression* new_literal(const uint8_t& literal);
 	Expression* new_signed_literal(const uint16_t& signedLiteral);
 	Expression* new_primitive(const uint8_t& primitive);
-	Expression* new_number(const Function& function, const uint16_t& index);
-	Expression* new_string(const Function& function, const uint16_t& index);
+	Expression* new_number(Function& function, const uint16_t& index);
+	Expression* new_string(Function& function, const uint16_t& index);
 	Expression* new_table(const Function& function, const uint16_t& index);
 	Expression* new_cdata(const Function& function, const uint16_t& index);
 
-	static uint32_t get_block_index_from_id(const std::vector<Statement*>& block, const uint32_t& id);
+	static uint32_t get_block_index_from_id(const std::vector<StatementIndex>& block, const uint32_t& id);
 	static uint32_t get_extended_id_from_statement(Statement* const& statement);
 	static uint32_t get_label_from_next_statement(Function& function, const BlockInfo& blockInfo, const bool& returnExtendedLabel, const bool& excludeDeclaration);
 	static bool is_valid_block(Function& function, const BlockInfo& blockInfo, const uint32_t& blockBegin);
 	static void check_valid_name(Constant* const& constant);
+	bool is_special_number(const double& number, const bool& isCdata = false);
 	void check_special_number(Expression* const& expression, const bool& isCdata = false);
 	static CONSTANT_TYPE get_constant_type(Expression* const& expression);
 
-	const Bytecode& bytecode;
+	Bytecode& bytecode;
 	const bool ignoreDebugInfo;
 	const bool minimizeDiffs;
+	const bool lowMemory;
+	Stats* const stats;
+	Buffers* const buffers;
 	bool isFR2Enabled = false;
 	std::vector<Statement*> statements;
 	std::vector<Function*> functions;
 	std::vector<Expression*> expressions;
+	std::vector<SlotScope*> slotScopes;
+	std::vector<Function*> builtFunctions;
+	std::unordered_map<const Bytecode::Prototype*, uint32_t> functionCounts;
+	Expression* primitiveExpressions[3] = {};
+	std::unordered_map<int32_t, Expression*> literalExpressions;
+	uint32_t chunkStatementCount = 0;
+	uint32_t chunkFunctionCount = 0;
+	uint32_t chunkExpressionCount = 0;
+	uint32_t chunkSlotScopeCount = 0;
 	uint64_t prototypeDataLeft = 0;
+
+	static inline thread_local Ast* boundAst = nullptr;
 };
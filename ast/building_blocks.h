@@ -9,7 +9,7 @@ enum AST_EXPRESSION {
 	AST_EXPRESSION_UNARY_OPERATION
 };
 
-struct Ast::Expression {
+struct Expression {
 	Expression(const AST_EXPRESSION& type) {
 		set_type(type);
 	}
@@ -80,6 +80,7 @@ struct Ast::Expression {
 	}
 
 	AST_EXPRESSION type;
+	uint32_t index = INVALID_ID;
 
 	union {
 		Constant* constant = nullptr;
@@ -104,7 +105,7 @@ enum AST_CONSTANT {
 	AST_CONSTANT_STRING
 };
 
-struct Ast::Constant {
+struct Constant {
 	AST_CONSTANT type;
 
 	union {
@@ -124,39 +125,40 @@ enum AST_VARIABLE {
 	AST_VARIABLE_TABLE_INDEX
 };
 
-struct Ast::Variable {
+struct Variable {
 	AST_VARIABLE type;
 	uint8_t slot = 0;
-	SlotScope** slotScope = nullptr;
-	std::string name;
-	Expression* table = nullptr;
-	Expression* tableIndex = nullptr;
+	SlotScopeIndex slotScope;
+	const std::string* name = nullptr;
+	ExpressionIndex table;
+	ExpressionIndex tableIndex;
 	bool isMultres = false;
 	uint32_t multresIndex = 0;
 };
 
-struct Ast::FunctionCall {
-	Expression* function = nullptr;
-	std::vector<Expression*> arguments;
-	Expression* multresArgument = nullptr;
+struct FunctionCall {
+	ExpressionIndex function;
+	std::vector<ExpressionIndex> arguments;
+	ExpressionIndex multresArgument;
 	bool isMethod = false;
 	uint8_t returnCount = 0;
 };
 
-struct Ast::Table {
+struct Table {
 	struct Field {
-		Expression* key = nullptr;
-		Expression* value = nullptr;
+		ExpressionIndex key;
+		ExpressionIndex value;
 	};
 
 	struct {
-		std::vector<Expression*> list;
-		std::vector<Field> fields;
+		const Bytecode::Constant* table = nullptr;
+		std::vector<bool> removedFields;
+		uint32_t fieldCount = 0;
 	} constants;
 
 	std::vector<Field> fields;
 	uint32_t multresIndex = 0;
-	Expression* multresField = nullptr;
+	ExpressionIndex multresField;
 };
 
 enum AST_BINARY_OPERATION {
@@ -177,10 +179,10 @@ enum AST_BINARY_OPERATION {
 	AST_BINARY_OR
 };
 
-struct Ast::BinaryOperation {
+struct BinaryOperation {
 	AST_BINARY_OPERATION type;
-	Expression* leftOperand = nullptr;
-	Expression* rightOperand = nullptr;
+	ExpressionIndex leftOperand;
+	ExpressionIndex rightOperand;
 };
 
 enum AST_UNARY_OPERATION {
@@ -189,12 +191,12 @@ enum AST_UNARY_OPERATION {
 	AST_UNARY_LENGTH
 };
 
-struct Ast::UnaryOperation {
+struct UnaryOperation {
 	AST_UNARY_OPERATION type;
-	Expression* operand = nullptr;
+	ExpressionIndex operand;
 };
 
-enum AST_STATEMENT {
+enum AST_STATEMENT : uint8_t {
 	AST_STATEMENT_EMPTY,
 	AST_STATEMENT_INSTRUCTION,
 	AST_STATEMENT_RETURN,
@@ -215,10 +217,16 @@ enum AST_STATEMENT {
 	AST_STATEMENT_LABEL
 };
 
-struct Ast::Statement {
+struct Statement {
 	Statement(const AST_STATEMENT& type) : type(type) {}
 
 	AST_STATEMENT type;
+	uint32_t index = INVALID_ID;
+
+	struct {
+		bool allowSlotSwap = false;
+		bool swapped = false;
+	} condition;
 
 	struct {
 		Bytecode::BC_OP type = Bytecode::BC_OP_INVALID;
@@ -231,23 +239,18 @@ struct Ast::Statement {
 		uint32_t label = INVALID_ID;
 	} instruction;
 
+	std::vector<StatementIndex> block;
 	Function* function = nullptr;
-	std::vector<Statement*> block;
 	Local* locals = nullptr;
 
 	struct {
-		bool allowSlotSwap = false;
-		bool swapped = false;
-	} condition;
-
-	struct {
-		void register_slots(Expression*& expression) {
-			openSlots.emplace_back(&expression);
+		void register_slots(const ExpressionIndex& expression) {
+			openSlots.emplace_back(expression);
 		}
 
 		template <typename... Expressions>
-		void register_slots(Expression*& expression, Expressions*&... expressions) {
-			openSlots.emplace_back(&expression);
+		void register_slots(const ExpressionIndex& expression, const Expressions&... expressions) {
+			openSlots.emplace_back(expression);
 			return register_slots(expressions...);
 		}
 
@@ -255,9 +258,9 @@ struct Ast::Statement {
 		bool isTableConstructor = false;
 		bool forwardDeclaration = false;
 		CONSTANT_TYPE allowedConstantType = NUMBER_CONSTANT;
+		ExpressionIndex multresReturn;
 		std::vector<Variable> variables;
-		std::vector<Expression*> expressions;
-		std::vector<Expression**> openSlots;
-		Expression* multresReturn = nullptr;
+		std::vector<ExpressionIndex> expressions;
+		std::vector<ExpressionIndex> openSlots;
 	} assignment;
 };
@@ -1,4 +1,4 @@
-struct Ast::ConditionBuilder {
+struct ConditionBuilder {
 	enum TYPE {
 		ASSIGNMENT,
 		STATEMENT
@@ -59,7 +59,7 @@ struct Ast::ConditionBuilder {
 		Node* targetNode = nullptr;
 		uint32_t incomingNodes = 0;
 		bool inverted = false;
-		std::vector<Expression*>* expressions = nullptr;
+		std::vector<ExpressionIndex>* expressions = nullptr;
 		Node* leftNode = nullptr;
 		Node* rightNode = nullptr;
 	};
@@ -119,7 +119,7 @@ struct Ast::ConditionBuilder {
 		}
 	}
 
-	void add_node(const Node::TYPE& type, const uint32_t& nodeLabel, const uint32_t& targetLabel, std::vector<Expression*>* const& expressions) {
+	void add_node(const Node::TYPE& type, const uint32_t& nodeLabel, const uint32_t& targetLabel, std::vector<ExpressionIndex>* const& expressions) {
 		conditionNodes.emplace_back(new_node(type));
 		conditionNodes.back()->nodeLabel = nodeLabel;
 		conditionNodes.back()->targetLabel = targetLabel;
@@ -265,7 +265,7 @@ struct Ast::ConditionBuilder {
 		node->inverted = targetNode->inverted;
 	}
 
-	Expression* build_expression(Node* const& node) {
+	ExpressionIndex build_expression(Node* const& node) {
 		switch (node->type) {
 		case Node::LESS_THAN:
 		case Node::LESS_EQUAL:
@@ -304,14 +304,14 @@ struct Ast::ConditionBuilder {
 		}
 	}
 
-	Expression* build_not(Expression* const& operand) {
+	ExpressionIndex build_not(const ExpressionIndex& operand) {
 		Expression* const expression = ast.new_expression(AST_EXPRESSION_UNARY_OPERATION);
 		expression->unaryOperation->type = AST_UNARY_NOT;
 		expression->unaryOperation->operand = operand;
 		return expression;
 	}
 
-	Expression* build_binary(const Node::TYPE& type, Expression* const& leftOperand, Expression* const& rightOperand) {
+	ExpressionIndex build_binary(const Node::TYPE& type, const ExpressionIndex& leftOperand, const ExpressionIndex& rightOperand) {
 		Expression* const expression = ast.new_expression(AST_EXPRESSION_BINARY_OPERATION);
 
 		switch (type) {
@@ -354,7 +354,7 @@ struct Ast::ConditionBuilder {
 		return expression;
 	}
 
-	Expression* build_condition() {
+	ExpressionIndex build_condition() {
 		if (link_nodes()) {
 			fix_return_nodes();
 			if (build_boolean_logic()) return build_expression(conditionNodes.back());
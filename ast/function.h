@@ -1,4 +1,4 @@
-struct Ast::Local {
+struct Local {
 	std::vector<std::string> names;
 	uint8_t baseSlot = 0;
 	uint32_t scopeBegin = INVALID_ID;
@@ -6,19 +6,19 @@ struct Ast::Local {
 	bool excludeBlock = false;
 };
 
-struct Ast::SlotScope {
-	SlotScope* slotScope = this;
-	std::vector<SlotScope**> mergedScopes;
+struct SlotScope {
+	SlotScopeIndex slotScope;
+	std::vector<SlotScopeIndex> mergedScopes;
 	std::string name;
 	uint32_t scopeBegin = INVALID_ID;
 	uint32_t scopeEnd = INVALID_ID;
 	uint32_t usages = 0;
 };
 
-struct Ast::Function {
+struct Function {
 	struct Upvalue {
 		uint8_t slot = 0;
-		SlotScope** slotScope = nullptr;
+		SlotScopeIndex slotScope;
 		bool local = false;
 	};
 
@@ -28,6 +28,11 @@ struct Ast::Function {
 		std::vector<uint32_t> jumpIds;
 	};
 
+	struct Jump {
+		uint32_t id = INVALID_ID;
+		uint32_t target = INVALID_ID;
+	};
+
 	Function(const Bytecode::Prototype& prototype, const uint32_t& level, const bool& ignoreDebugInfo)
 		: prototype(prototype), isVariadic(prototype.header.flags& Bytecode::BC_PROTO_VARARG), level(level), hasDebugInfo(!ignoreDebugInfo && prototype.header.hasDebugInfo) {
 		slotScopeCollector.slotInfos.resize(prototype.header.framesize);
@@ -40,10 +45,17 @@ struct Ast::Function {
 		slotScopeCollector.previousId = prototype.instructions.size();
 	}
 
-	~Function() {
-		for (uint32_t i = slotScopeCollector.slotScopes.size(); i--;) {
-			delete slotScopeCollector.slotScopes[i];
-		}
+	void release() {
+		slotScopeCollector = SlotScopeCollector();
+		locals = std::vector<Local>();
+		upvalues = std::vector<Upvalue>();
+		labels = std::vector<Label>();
+		parameterNames = std::vector<std::string>();
+		block = std::vector<StatementIndex>();
+		childFunctions = std::vector<Function*>();
+		usedGlobals = std::vector<const std::string*>();
+		stringExpressions = std::vector<Expression*>();
+		numberExpressions = std::vector<Expression*>();
 	}
 
 	const Bytecode::Constant& get_constant(const uint16_t& index) const {
@@ -54,49 +66,57 @@ struct Ast::Function {
 		return prototype.numberConstants[index];
 	}
 
-	void add_jump(const uint32_t& id, const uint32_t& target) {
-		for (uint32_t i = 0; i < labels.size(); i++) {
-			if (target > labels[i].target) continue;
-
-			if (target != labels[i].target) {
-				labels.emplace(labels.begin() + i);
-				labels[i].target = target;
-			}
+	uint32_t get_label_index(const uint32_t& target) {
+		return std::lower_bound(labels.begin(), labels.end(), target, [](const Label& label, const uint32_t& target)->bool {
+			return label.target < target;
+		}) - labels.begin();
+	}
 
-			for (uint32_t j = 0; j < labels[i].jumpIds.size(); j++) {
-				if (id > labels[i].jumpIds[j]) continue;
-				if (id < labels[i].jumpIds[j]) labels[i].jumpIds.emplace(labels[i].jumpIds.begin() + j, id);
-				return;
-			}
+	void add_jump(const uint32_t& id, const uint32_t& target) {
+		const uint32_t label = get_label_index(target);
 
-			labels[i].jumpIds.emplace_back(id);
-			return;
+		if (label == labels.size() || labels[label].target != target) {
+			labels.emplace(labels.begin() + label);
+			labels[label].target = target;
 		}
 
-		labels.emplace_back();
-		labels.back().target = target;
-		labels.back().jumpIds.emplace_back(id);
+		const std::vector<uint32_t>::iterator jumpId = std::lower_bound(labels[label].jumpIds.begin(), labels[label].jumpIds.end(), id);
+		if (jumpId == labels[label].jumpIds.end() || *jumpId != id) labels[label].jumpIds.emplace(jumpId, id);
 	}
 
-	void remove_jump(const uint32_t& id, const uint32_t& target) {
+	void add_jumps(std::vector<Jump>& jumps) {
 		for (uint32_t i = labels.size(); i--;) {
-			if (labels[i].target != target) continue;
-
 			for (uint32_t j = labels[i].jumpIds.size(); j--;) {
-				if (labels[i].jumpIds[j] != id) continue;
-				labels[i].jumpIds.erase(labels[i].jumpIds.begin() + j);
-				return;
+				jumps.emplace_back(Jump{ .id = labels[i].jumpIds[j], .target = labels[i].target });
 			}
 		}
-	}
 
-	uint32_t get_label_from_id(const uint32_t& id) {
-		for (uint32_t i = labels.size(); i-- && labels[i].target >= id;) {
-			if (labels[i].target != id) continue;
-			return i;
+		std::sort(jumps.begin(), jumps.end(), [](const Jump& left, const Jump& right)->bool {
+			return left.target != right.target ? left.target < right.target : left.id < right.id;
+		});
+
+		labels.clear();
+
+		for (uint32_t i = 0; i < jumps.size(); i++) {
+			if (!labels.size() || labels.back().target != jumps[i].target) {
+				labels.emplace_back();
+				labels.back().target = jumps[i].target;
+			}
+
+			if (!labels.back().jumpIds.size() || labels.back().jumpIds.back() != jumps[i].id) labels.back().jumpIds.emplace_back(jumps[i].id);
 		}
+	}
+
+	void remove_jump(const uint32_t& id, const uint32_t& target) {
+		const uint32_t label = get_label_from_id(target);
+		if (label == INVALID_ID) return;
+		const std::vector<uint32_t>::iterator jumpId = std::lower_bound(labels[label].jumpIds.begin(), labels[label].jumpIds.end(), id);
+		if (jumpId != labels[label].jumpIds.end() && *jumpId == id) labels[label].jumpIds.erase(jumpId);
+	}
 
-		return INVALID_ID;
+	uint32_t get_label_from_id(const uint32_t& id) {
+		const uint32_t label = get_label_index(id);
+		return label != labels.size() && labels[label].target == id ? label : INVALID_ID;
 	}
 
 	bool is_valid_label(const uint32_t& label) {
@@ -124,9 +144,11 @@ struct Ast::Function {
 	}
 
 	bool is_valid_block_range(const uint32_t& blockBegin, const uint32_t& blockEnd, const bool& ignoreFrontLabel) {
-		for (uint32_t i = labels.size(); i-- && labels[i].target >= blockBegin;) {
-			if (labels[i].target <= blockEnd
-				&& labels[i].jumpIds.size()
+		uint32_t label = get_label_index(blockEnd);
+		if (label != labels.size() && labels[label].target == blockEnd) label++;
+
+		for (uint32_t i = label; i-- && labels[i].target >= blockBegin;) {
+			if (labels[i].jumpIds.size()
 				&& ((labels[i].jumpIds.front() < blockBegin
 						&& (labels[i].target != blockBegin
 							|| !ignoreFrontLabel))
@@ -142,13 +164,16 @@ struct Ast::Function {
 	const uint32_t level;
 	uint32_t id = 0;
 	bool assignmentSlotIsUpvalue = false;
+	bool isBuilt = false;
 	std::vector<Local> locals;
 	std::vector<Upvalue> upvalues;
 	std::vector<Label> labels;
 	std::vector<std::string> parameterNames;
-	std::vector<Statement*> block;
+	std::vector<StatementIndex> block;
 	std::vector<Function*> childFunctions;
 	std::vector<const std::string*> usedGlobals;
+	std::vector<Expression*> stringExpressions;
+	std::vector<Expression*> numberExpressions;
 
 	struct SlotScopeCollector {
 		struct UpvalueInfo {
@@ -162,6 +187,7 @@ struct Ast::Function {
 			uint32_t target = INVALID_ID;
 			std::vector<uint8_t> upvalues;
 			uint8_t baseSlot = 0;
+			bool isLoopEnd = false;
 		};
 
 		struct UpvalueScope {
@@ -172,24 +198,16 @@ struct Ast::Function {
 
 		struct SlotInfo {
 			bool isParameter = false;
-			SlotScope** activeSlotScope = nullptr;
+			SlotScopeIndex activeSlotScope;
 			uint32_t minScopeBegin = INVALID_ID;
-			std::vector<SlotScope**> slotScopes;
+			std::vector<SlotScopeIndex> slotScopes;
 		};
 
-		SlotScope** new_slot_scope() {
-			return &slotScopes.emplace_back(new SlotScope)->slotScope;
+		SlotScopeIndex new_slot_scope() {
+			return boundAst->new_slot_scope();
 		}
 
 		uint32_t add_upvalue_info(const uint32_t& id, const UpvalueInfo::TYPE& type) {
-			for (uint32_t i = 0; i < upvalueInfos.size(); i++) {
-				if (id > upvalueInfos[i].id) continue;
-				upvalueInfos.emplace(upvalueInfos.begin() + i);
-				upvalueInfos[i].type = type;
-				upvalueInfos[i].id = id;
-				return i;
-			}
-
 			upvalueInfos.emplace_back();
 			upvalueInfos.back().type = type;
 			upvalueInfos.back().id = id;
@@ -211,16 +229,35 @@ struct Ast::Function {
 		}
 
 		void add_loop(const uint32_t& id, const uint32_t& target) {
-			uint32_t index = add_upvalue_info(id, UpvalueInfo::JUMP);
-			upvalueInfos[index].target = target;
+			upvalueInfos[add_upvalue_info(id, UpvalueInfo::JUMP)].target = target;
+			const uint32_t index = add_upvalue_info(target - 1, UpvalueInfo::JUMP);
+			upvalueInfos[index].target = id;
+			upvalueInfos[index].isLoopEnd = true;
+		}
 
-			do {
-				index++;
-			} while (index < upvalueInfos.size() && upvalueInfos[index].id < target);
+		void sort_upvalue_infos() {
+			// Infos are added out of order and sorted by id once. A later info goes in front of earlier ones with the same id,
+			// except for the end of a loop, which goes behind them.
+			std::vector<uint32_t> order(upvalueInfos.size());
 
-			upvalueInfos.emplace(upvalueInfos.begin() + index);
-			upvalueInfos[index].id = target - 1;
-			upvalueInfos[index].target = id;
+			for (uint32_t i = order.size(); i--;) {
+				order[i] = i;
+			}
+
+			std::sort(order.begin(), order.end(), [this](const uint32_t& left, const uint32_t& right)->bool {
+				if (upvalueInfos[left].id != upvalueInfos[right].id) return upvalueInfos[left].id < upvalueInfos[right].id;
+				if (upvalueInfos[left].isLoopEnd != upvalueInfos[right].isLoopEnd) return upvalueInfos[right].isLoopEnd;
+				return upvalueInfos[left].isLoopEnd == (left < right);
+			});
+
+			std::vector<UpvalueInfo> sortedInfos;
+			sortedInfos.reserve(order.size());
+
+			for (uint32_t i = 0; i < order.size(); i++) {
+				sortedInfos.emplace_back(std::move(upvalueInfos[order[i]]));
+			}
+
+			upvalueInfos = std::move(sortedInfos);
 		}
 
 		void add_upvalue_scope(const uint8_t& slot, const uint32_t& minScopeBegin, const uint32_t& minScopeEnd) {
@@ -293,7 +330,8 @@ struct Ast::Function {
 			if (slotInfos[slot].activeSlotScope) return;
 			slotInfos[slot].slotScopes.emplace_back(new_slot_scope());
 			slotInfos[slot].activeSlotScope = slotInfos[slot].slotScopes.back();
-			(*slotInfos[slot].activeSlotScope)->scopeEnd = id;
+			slotInfos[slot].activeSlotScope->slotScope->scopeEnd = id;
+			activeSlots[slot / 64] |= (uint64_t)1 << slot % 64;
 		}
 
 		void begin_upvalue_scopes(const uint32_t& id) {
@@ -307,22 +345,23 @@ struct Ast::Function {
 			}
 		}
 
-		void add_to_scope(const uint8_t& slot, SlotScope**& slotScope, const uint32_t& id) {
+		void add_to_scope(const uint8_t& slot, SlotScopeIndex& slotScope, const uint32_t& id) {
 			begin_scope(slot, id);
 			slotScope = slotInfos[slot].activeSlotScope;
-			(*slotInfos[slot].activeSlotScope)->usages++;
+			slotInfos[slot].activeSlotScope->slotScope->usages++;
 		}
 
-		void close_scope(const uint8_t& slot, SlotScope**& slotScope, const uint32_t& id) {
+		void close_scope(const uint8_t& slot, SlotScopeIndex& slotScope, const uint32_t& id) {
 			if (slotInfos[slot].isParameter
 				|| (slotInfos[slot].minScopeBegin != INVALID_ID
 					&& slotInfos[slot].minScopeBegin < id))
 				return add_to_scope(slot, slotScope, id);
 			begin_scope(slot, id);
 			slotScope = slotInfos[slot].activeSlotScope;
-			(*slotInfos[slot].activeSlotScope)->scopeBegin = id;
-			slotInfos[slot].activeSlotScope = nullptr;
+			slotInfos[slot].activeSlotScope->slotScope->scopeBegin = id;
+			slotInfos[slot].activeSlotScope = SlotScopeIndex();
 			slotInfos[slot].minScopeBegin = INVALID_ID;
+			activeSlots[slot / 64] &= ~((uint64_t)1 << slot % 64);
 		}
 
 		void extend_scope(const uint8_t& slot, const uint32_t& id) {
@@ -333,45 +372,51 @@ struct Ast::Function {
 				slotInfos[slot].minScopeBegin = id;
 		}
 
+		template <typename Callback>
+		void for_each_active_slot(const Callback& callback) {
+			uint8_t slot;
+
+			for (uint8_t i = std::size(activeSlots); i--;) {
+				for (uint64_t slots = activeSlots[i]; slots; slots ^= (uint64_t)1 << slot % 64) {
+					slot = i * 64 + 63 - std::countl_zero(slots);
+					callback(slot);
+				}
+			}
+		}
+
 		void extend_scopes(const uint32_t& id) {
-			for (uint8_t i = slotInfos.size(); i--;) {
+			for_each_active_slot([this, &id](const uint8_t& i)->void {
 				extend_scope(i, id);
-			}
+			});
 		}
 
 		void merge_scopes(const uint32_t& id) {
-			for (uint8_t i = slotInfos.size(); i--;) {
-				if (slotInfos[i].isParameter || !slotInfos[i].activeSlotScope) continue;
-
-				for (uint32_t j = slotInfos[i].slotScopes.size() - 1; j-- && (*slotInfos[i].slotScopes[j])->scopeBegin <= id;) {
-					(*slotInfos[i].activeSlotScope)->scopeEnd = (*slotInfos[i].slotScopes[j])->scopeEnd;
-					(*slotInfos[i].activeSlotScope)->usages += (*slotInfos[i].slotScopes[j])->usages + 1;
+			for_each_active_slot([this, &id](const uint8_t& i)->void {
+				for (uint32_t j = slotInfos[i].slotScopes.size() - 1; j-- && slotInfos[i].slotScopes[j]->slotScope->scopeBegin <= id;) {
+					slotInfos[i].activeSlotScope->slotScope->scopeEnd = slotInfos[i].slotScopes[j]->slotScope->scopeEnd;
+					slotInfos[i].activeSlotScope->slotScope->usages += slotInfos[i].slotScopes[j]->slotScope->usages + 1;
 
-					for (uint32_t k = (*slotInfos[i].slotScopes[j])->mergedScopes.size(); k--;) {
-						*(*slotInfos[i].slotScopes[j])->mergedScopes[k] = *slotInfos[i].activeSlotScope;
+					for (uint32_t k = slotInfos[i].slotScopes[j]->slotScope->mergedScopes.size(); k--;) {
+						slotInfos[i].slotScopes[j]->slotScope->mergedScopes[k]->slotScope = slotInfos[i].activeSlotScope->slotScope;
 					}
 
-					(*slotInfos[i].activeSlotScope)->mergedScopes.insert((*slotInfos[i].activeSlotScope)->mergedScopes.end(), (*slotInfos[i].slotScopes[j])->mergedScopes.begin(), (*slotInfos[i].slotScopes[j])->mergedScopes.end());
-					(*slotInfos[i].activeSlotScope)->mergedScopes.emplace_back(&(*slotInfos[i].slotScopes[j])->slotScope);
-					*slotInfos[i].slotScopes[j] = *slotInfos[i].activeSlotScope;
+					slotInfos[i].activeSlotScope->slotScope->mergedScopes.insert(slotInfos[i].activeSlotScope->slotScope->mergedScopes.end(), slotInfos[i].slotScopes[j]->slotScope->mergedScopes.begin(), slotInfos[i].slotScopes[j]->slotScope->mergedScopes.end());
+					slotInfos[i].activeSlotScope->slotScope->mergedScopes.emplace_back(slotInfos[i].slotScopes[j]->slotScope);
+					slotInfos[i].slotScopes[j]->slotScope = slotInfos[i].activeSlotScope->slotScope;
 					slotInfos[i].slotScopes.erase(slotInfos[i].slotScopes.begin() + j);
 				}
 
-				if ((*slotInfos[i].activeSlotScope)->scopeEnd < id) (*slotInfos[i].activeSlotScope)->scopeEnd = id;
-			}
+				if (slotInfos[i].activeSlotScope->slotScope->scopeEnd < id) slotInfos[i].activeSlotScope->slotScope->scopeEnd = id;
+			});
 		}
 
 		bool assert_scopes_closed() {
-			for (uint8_t i = slotInfos.size(); i--;) {
-				if (!slotInfos[i].isParameter && slotInfos[i].activeSlotScope) return false;
-			}
-
-			return true;
+			return !(activeSlots[0] | activeSlots[1] | activeSlots[2] | activeSlots[3]);
 		}
 
-		void remove_scope(const uint8_t& slot, SlotScope** const& slotScope) {
+		void remove_scope(const uint8_t& slot, const SlotScopeIndex& slotScope) {
 			for (uint32_t i = slotInfos[slot].slotScopes.size(); i--;) {
-				if (slotInfos[slot].slotScopes[i] != slotScope) continue;
+				if (slotInfos[slot].slotScopes[i].index != slotScope.index) continue;
 				slotInfos[slot].slotScopes.erase(slotInfos[slot].slotScopes.begin() + i);
 				return;
 			}
@@ -380,7 +425,7 @@ struct Ast::Function {
 		std::vector<UpvalueInfo> upvalueInfos;
 		std::vector<UpvalueScope> upvalueScopes;
 		std::vector<SlotInfo> slotInfos;
-		std::vector<SlotScope*> slotScopes;
+		uint64_t activeSlots[4] = {};
 		uint32_t previousId = INVALID_ID;
 	} slotScopeCollector;
 };
@@ -1,6 +1,11 @@
-#include "..\main.h"
+#include "../main.h"
 
-Bytecode::Bytecode(const std::string& filePath) : filePath(filePath) {}
+Bytecode::Bytecode(const std::string& filePath, const uint8_t* const& fileData, const uint64_t& fileDataSize, const uint32_t& threadCount, Buffers* const& buffers)
+	: filePath(filePath), fileData(fileData), fileDataSize(fileDataSize), threadCount(threadCount), buffers(buffers) {
+	if (!buffers) return;
+	fileBuffer.swap(buffers->fileBuffer);
+	prototypes.swap(buffers->prototypes);
+}
 
 Bytecode::~Bytecode() {
 	close_file();
@@ -8,9 +13,16 @@ Bytecode::~Bytecode() {
 	for (uint64_t i = prototypes.size(); i--;) {
 		delete prototypes[i];
 	}
+
+	if (!buffers) return;
+	fileBuffer.clear();
+	prototypes.clear();
+	fileBuffer.swap(buffers->fileBuffer);
+	prototypes.swap(buffers->prototypes);
 }
 
 void Bytecode::operator()() {
+	TRACE_SCOPE("Bytecode::operator()");
 	print_progress_bar();
 	open_file();
 	read_header();
@@ -18,10 +30,21 @@ void Bytecode::operator()() {
 	read_prototypes();
 	close_file();
 	fileBuffer.clear();
-	fileBuffer.shrink_to_fit();
+	if (!buffers) fileBuffer.shrink_to_fit();
 	erase_progress_bar();
 }
 
+void Bytecode::release_prototype(const Prototype& prototype) {
+	const uint32_t index = prototype.index;
+
+	for (uint32_t i = prototype.constants.size(); i--;) {
+		if (prototype.constants[i].type == BC_KGC_CHILD) release_prototype(*prototype.constants[i].prototype);
+	}
+
+	delete prototypes[index];
+	prototypes[index] = nullptr;
+}
+
 void Bytecode::read_header() {
 	read_file(5);
 	assert(fileBuffer[0] == BC_HEADER[0] &&
@@ -36,7 +59,6 @@ void Bytecode::read_header() {
 	assert(header.version == BC_VERSION_1 || header.version == BC_VERSION_2 || header.version == BC_VERSION_3, "Invalid bytecode version (" + byte_to_string(fileBuffer[3]) + ")", filePath, DEBUG_INFO);
 	header.flags = fileBuffer[4];
 	assert(!(header.flags & ~(BC_F_BE | BC_F_STRIP | BC_F_FFI | (header.version == BC_VERSION_2 ? BC_F_FR2 : 0))), "Invalid flags (" + byte_to_string(header.flags) + ")", filePath, DEBUG_INFO);
-	assert(!(header.flags & BC_F_BE), "Big endian support not implemented", filePath, DEBUG_INFO); //TODO
 	if (header.flags & BC_F_STRIP) return;
 	read_file(read_uleb128());
 	header.chunkname.resize(fileBuffer.size());
@@ -44,13 +66,74 @@ void Bytecode::read_header() {
 }
 
 void Bytecode::read_prototypes() {
+	if (threadCount > 1 && bytesUnread <= UINT32_MAX) {
+		try {
+			buffer_prototype_blocks();
+		} catch (...) {
+			exception = std::current_exception();
+		}
+
+		failedPrototype = prototypes.size();
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 1; i < std::min<uint64_t>(threadCount, prototypes.size()); i++) {
+			threads.emplace_back([this] {
+				read_next_prototypes(false);
+			});
+		}
+
+		read_next_prototypes(true);
+
+		for (uint32_t i = threads.size(); i--;) {
+			threads[i].join();
+		}
+
+		if (exception) std::rethrow_exception(exception);
+		prototypeBlocks.clear();
+	} else {
+		while (buffer_next_block(false)) {
+			prototypes.emplace_back(new Prototype(*this));
+			(*prototypes.back())(fileBuffer.data(), fileBuffer.size());
+			print_progress_bar(prototypesTotalSize - bytesUnread - 1, prototypesTotalSize);
+		}
+	}
+
+	link_prototypes();
+	if (!buffers) prototypes.shrink_to_fit();
+}
+
+void Bytecode::read_next_prototypes(const bool& showProgress) {
+	for (uint32_t i = nextPrototype++; i < failedPrototype; i = nextPrototype++) {
+		try {
+			(*prototypes[i])(fileBuffer.data() + prototypeBlocks[i].offset, prototypeBlocks[i].size);
+			prototypeDataRead += prototypeBlocks[i].size;
+		} catch (...) {
+			const std::lock_guard<std::mutex> lock(exceptionMutex);
+
+			if (i < failedPrototype) {
+				exception = std::current_exception();
+				failedPrototype = i;
+			}
+
+			return;
+		}
+
+		if (showProgress) print_progress_bar(prototypeDataRead, prototypesTotalSize);
+	}
+}
+
+void Bytecode::link_prototypes() {
 	std::vector<Prototype*> unlinkedPrototypes;
 
-	while (buffer_next_block()) {
-		assert(fileBuffer.size() >= MIN_PROTO_SIZE, "Prototype is too short", filePath, DEBUG_INFO);
-		prototypes.emplace_back(new Prototype(*this));
-		(*prototypes.back())(unlinkedPrototypes);
-		print_progress_bar(prototypesTotalSize - bytesUnread - 1, prototypesTotalSize);
+	for (uint32_t i = 0; i < prototypes.size(); i++) {
+		for (uint32_t j = 0; j < prototypes[i]->constants.size(); j++) {
+			if (prototypes[i]->constants[j].type != BC_KGC_CHILD) continue;
+			assert(unlinkedPrototypes.size(), "Failed to link child prototype", filePath, DEBUG_INFO);
+			prototypes[i]->constants[j].prototype = unlinkedPrototypes.back();
+			unlinkedPrototypes.pop_back();
+		}
+
+		unlinkedPrototypes.emplace_back(prototypes[i]);
 	}
 
 	assert(unlinkedPrototypes.size() == 1, "Failed to link main prototype", filePath, DEBUG_INFO);
@@ -59,35 +142,41 @@ void Bytecode::read_prototypes() {
 		&& !main->header.parameters
 		&& !main->upvalues.size(),
 		"Main prototype has invalid header", filePath, DEBUG_INFO);
-	prototypes.shrink_to_fit();
 }
 
 void Bytecode::open_file() {
-	file = CreateFileA(filePath.c_str(), GENERIC_READ, NULL, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-	assert(file != INVALID_HANDLE_VALUE, "Unable to open file", filePath, DEBUG_INFO);
-	fileSize |= (uint64_t)GetFileSize(file, (DWORD*)&fileSize) << 32;
-	fileSize = (fileSize >> 32) | (fileSize << 32);
+	if (fileData) {
+		fileSize = fileDataSize;
+	} else {
+		assert(file.open(filePath), "Unable to open file", filePath, DEBUG_INFO);
+		fileSize = file.size;
+	}
+
 	assert(fileSize >= MIN_FILE_SIZE, "File is too small or empty", filePath, DEBUG_INFO);
 	bytesUnread = fileSize;
 }
 
 void Bytecode::close_file() {
-	if (file == INVALID_HANDLE_VALUE) return;
-	CloseHandle(file);
-	file = INVALID_HANDLE_VALUE;
+	file.close();
 }
 
-void Bytecode::read_file(const uint32_t& byteCount) {
+void Bytecode::read_file(const uint32_t& byteCount, const bool& append) {
 	assert(bytesUnread >= byteCount, "Read would exceed end of file", filePath, DEBUG_INFO);
-	fileBuffer.resize(byteCount);
-	DWORD bytesRead = 0;
-	assert(ReadFile(file, fileBuffer.data(), byteCount, &bytesRead, NULL) && !(byteCount - bytesRead), "Failed to read file", filePath, DEBUG_INFO);
+	const uint64_t offset = append ? fileBuffer.size() : 0;
+	fileBuffer.resize(offset + byteCount);
+
+	if (fileData) {
+		std::memcpy(fileBuffer.data() + offset, fileData + fileSize - bytesUnread, byteCount);
+	} else {
+		assert(file.read(fileBuffer.data() + offset, byteCount), "Failed to read file", filePath, DEBUG_INFO);
+	}
+
 	bytesUnread -= byteCount;
 }
 
 uint32_t Bytecode::read_uleb128() {
-	read_file(1);
-	uint32_t uleb128 = fileBuffer[0];
+	uint8_t byte = read_byte();
+	uint32_t uleb128 = byte;
 
 	if (uleb128 >= 0x80) {
 		uleb128 &= 0x7F;
@@ -95,15 +184,22 @@ uint32_t Bytecode::read_uleb128() {
 
 		do {
 			bitShift += 7;
-			read_file(1);
-			uleb128 |= (fileBuffer[0] & 0x7F) << bitShift;
-		} while (fileBuffer[0] >= 0x80);
+			byte = read_byte();
+			uleb128 |= (byte & 0x7F) << bitShift;
+		} while (byte >= 0x80);
 	}
 
 	return uleb128;
 }
 
-bool Bytecode::buffer_next_block() {
+uint8_t Bytecode::read_byte() {
+	read_file(1, true);
+	const uint8_t byte = fileBuffer.back();
+	fileBuffer.pop_back();
+	return byte;
+}
+
+bool Bytecode::buffer_next_block(const bool& append) {
 	const uint32_t byteCount = read_uleb128();
 
 	if (!byteCount) {
@@ -111,6 +207,19 @@ bool Bytecode::buffer_next_block() {
 		return false;
 	}
 
-	read_file(byteCount);
+	read_file(byteCount, append);
+	assert(byteCount >= MIN_PROTO_SIZE, "Prototype is too short", filePath, DEBUG_INFO);
 	return true;
 }
+
+void Bytecode::buffer_prototype_blocks() {
+	fileBuffer.clear();
+	fileBuffer.reserve(bytesUnread);
+	uint64_t offset = 0;
+
+	while (buffer_next_block(true)) {
+		prototypeBlocks.emplace_back(PrototypeBlock{ .offset = offset, .size = (uint32_t)(fileBuffer.size() - offset) });
+		prototypes.emplace_back(new Prototype(*this));
+		offset = fileBuffer.size();
+	}
+}
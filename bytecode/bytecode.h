@@ -12,10 +12,16 @@ public:
 	#include "constants.h"
 	#include "instructions.h"
 
-	Bytecode(const std::string& filePath);
+	struct Buffers {
+		std::vector<uint8_t> fileBuffer;
+		std::vector<Prototype*> prototypes;
+	};
+
+	Bytecode(const std::string& filePath, const uint8_t* const& fileData = nullptr, const uint64_t& fileDataSize = 0, const uint32_t& threadCount = 1, Buffers* const& buffers = nullptr);
 	~Bytecode();
 
 	void operator()();
+	void release_prototype(const Prototype& prototype);
 
 	const std::string filePath;
 
@@ -33,17 +39,36 @@ private:
 	static constexpr uint8_t MIN_PROTO_SIZE = 11;
 	static constexpr uint8_t MIN_FILE_SIZE = MIN_PROTO_SIZE + 7;
 
+	struct PrototypeBlock {
+		uint64_t offset = 0;
+		uint32_t size = 0;
+	};
+
 	void read_header();
 	void read_prototypes();
+	void read_next_prototypes(const bool& showProgress);
+	void link_prototypes();
 	void open_file();
 	void close_file();
-	void read_file(const uint32_t& byteCount);
+	void read_file(const uint32_t& byteCount, const bool& append = false);
 	uint32_t read_uleb128();
-	bool buffer_next_block();
+	uint8_t read_byte();
+	bool buffer_next_block(const bool& append);
+	void buffer_prototype_blocks();
 
-	HANDLE file = INVALID_HANDLE_VALUE;
+	const uint8_t* const fileData;
+	const uint64_t fileDataSize;
+	const uint32_t threadCount;
+	Buffers* const buffers;
+	InputFile file;
 	uint64_t fileSize = 0;
 	uint64_t bytesUnread = 0;
 	std::vector<uint8_t> fileBuffer;
 	std::vector<Prototype*> prototypes;
+	std::vector<PrototypeBlock> prototypeBlocks;
+	std::atomic<uint32_t> nextPrototype = 0;
+	std::atomic<uint32_t> failedPrototype = 0;
+	std::atomic<uint64_t> prototypeDataRead = 0;
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
 };
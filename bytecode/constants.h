@@ -22,7 +22,7 @@ enum BC_KTAB {
 	BC_KTAB_STR  // string constant
 };
 
-struct Bytecode::TableConstant {
+struct TableConstant {
 	BC_KTAB type;
 
 	union {
@@ -33,7 +33,7 @@ struct Bytecode::TableConstant {
 	std::string string;
 };
 
-struct Bytecode::TableNode {
+struct TableNode {
 	TableConstant key;
 	TableConstant value;
 };
@@ -47,7 +47,7 @@ enum BC_KGC {
 	BC_KGC_STR // string constant
 };
 
-struct Bytecode::Constant {
+struct Constant {
 	BC_KGC type;
 	const Prototype* prototype = nullptr;
 	std::vector<TableConstant> array;
@@ -61,7 +61,7 @@ enum BC_KNUM {
 	BC_KNUM_NUM // number constant
 };
 
-struct Bytecode::NumberConstant {
+struct NumberConstant {
 	BC_KNUM type;
 	
 	union {
@@ -81,7 +81,7 @@ enum BC_VAR {
 	BC_VAR_STR // local variable name
 };
 
-struct Bytecode::VariableInfo {
+struct VariableInfo {
 	BC_VAR type;
 	std::string name;
 	bool isParameter = false;
@@ -1,6 +1,6 @@
 static constexpr uint16_t BC_OP_JMP_BIAS = 0x8000;
 
-enum BC_OP {
+enum BC_OP : uint8_t {
 	BC_OP_ISLT, // if A<VAR> < D<VAR> then JMP
 	BC_OP_ISGE, // if not (A<VAR> < D<VAR>) then JMP
 	BC_OP_ISLE, // if A<VAR> <= D<VAR> then JMP
@@ -101,7 +101,7 @@ enum BC_OP {
 	BC_OP_INVALID
 };
 
-struct Bytecode::Instruction {
+struct Instruction {
 	BC_OP type;
 	uint8_t a = 0;
 	uint8_t b = 0;
@@ -110,7 +110,8 @@ struct Bytecode::Instruction {
 };
 
 static BC_OP get_op_type(const uint8_t& byte, const uint8_t& version) {
-	return (BC_OP)(version == Bytecode::BC_VERSION_1 && byte >= BC_OP_ISTYPE ? (byte >= BC_OP_TGETR - 2 ? (byte >= BC_OP_TSETR - 3 ? byte + 4 : byte + 3) : byte + 2) : byte);
+	const uint32_t type = version == Bytecode::BC_VERSION_1 && byte >= BC_OP_ISTYPE ? (byte >= BC_OP_TGETR - 2 ? (byte >= BC_OP_TSETR - 3 ? byte + 4 : byte + 3) : byte + 2) : byte;
+	return type < BC_OP_INVALID ? (BC_OP)type : BC_OP_INVALID;
 }
 
 static bool is_op_abc_format(const BC_OP& instruction) {
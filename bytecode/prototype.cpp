@@ -1,16 +1,25 @@
-#include "..\main.h"
+#include "../main.h"
 
-Bytecode::Prototype::Prototype(const Bytecode& bytecode) : bytecode(bytecode) {}
+Bytecode::Prototype::Prototype(const Bytecode& bytecode) : index(bytecode.prototypes.size()), bytecode(bytecode) {}
 
-void Bytecode::Prototype::operator()(std::vector<Prototype*>& unlinkedPrototypes) {
+void Bytecode::Prototype::operator()(const uint8_t* const& data, const uint32_t& dataSize) {
+	this->data = data;
+	this->dataSize = dataSize;
 	read_header();
-	read_instructions();
-	read_upvalues();
-	read_constants(unlinkedPrototypes);
+
+	if (bytecode.header.flags & BC_F_BE) {
+		read_instructions<true>();
+		read_upvalues<true>();
+	} else {
+		read_instructions<false>();
+		read_upvalues<false>();
+	}
+
+	read_constants();
 	read_number_constants();
 	read_debug_info();
-	assert(prototypeSize == bytecode.fileBuffer.size(), "Prototype has unread bytes left", bytecode.filePath, DEBUG_INFO);
-	unlinkedPrototypes.emplace_back(this);
+	assert(prototypeSize == dataSize, "Prototype has unread bytes left", bytecode.filePath, DEBUG_INFO);
+	this->data = nullptr;
 }
 
 void Bytecode::Prototype::read_header() {
@@ -29,10 +38,14 @@ void Bytecode::Prototype::read_header() {
 	header.lineCount = get_uleb128();
 }
 
+template <bool IS_BIG_ENDIAN>
 void Bytecode::Prototype::read_instructions() {
+	uint32_t instruction;
+
 	for (uint32_t i = 0; i < instructions.size(); i++) {
-		instructions[i].type = get_op_type(get_next_byte(), bytecode.header.version);
-		assert(instructions[i].type < BC_OP_INVALID, "Prototype has invalid instruction (" + byte_to_string(instructions[i].type) + ")", bytecode.filePath, DEBUG_INFO);
+		instruction = get_integer<IS_BIG_ENDIAN, uint32_t>();
+		instructions[i].type = get_op_type(instruction, bytecode.header.version);
+		assert(instructions[i].type < BC_OP_INVALID, "Prototype has invalid instruction (" + byte_to_string(instruction) + ")", bytecode.filePath, DEBUG_INFO);
 
 		switch (instructions[i].type) {
 		case BC_OP_ISTYPE:
@@ -57,26 +70,25 @@ void Bytecode::Prototype::read_instructions() {
 			assert(false, "Prototype has unsupported instruction (" + byte_to_string(instructions[i].type) + ")", bytecode.filePath, DEBUG_INFO);
 		}
 
-		instructions[i].a = get_next_byte();
+		instructions[i].a = instruction >> 8;
 
 		if (is_op_abc_format(instructions[i].type)) {
-			instructions[i].c = get_next_byte();
-			instructions[i].b = get_next_byte();
+			instructions[i].c = instruction >> 16;
+			instructions[i].b = instruction >> 24;
 		} else {
-			instructions[i].d = get_next_byte();
-			instructions[i].d |= (uint16_t)get_next_byte() << 8;
+			instructions[i].d = instruction >> 16;
 		}
 	}
 }
 
+template <bool IS_BIG_ENDIAN>
 void Bytecode::Prototype::read_upvalues() {
 	for (uint8_t i = 0; i < upvalues.size(); i++) {
-		upvalues[i] = get_next_byte();
-		upvalues[i] |= (uint16_t)get_next_byte() << 8;
+		upvalues[i] = get_integer<IS_BIG_ENDIAN, uint16_t>();
 	}
 }
 
-void Bytecode::Prototype::read_constants(std::vector<Prototype*>& unlinkedPrototypes) {
+void Bytecode::Prototype::read_constants() {
 	uint32_t type;
 
 	for (uint32_t i = 0; i < constants.size(); i++) {
@@ -85,9 +97,6 @@ void Bytecode::Prototype::read_constants(std::vector<Prototype*>& unlinkedProtot
 		switch (type) {
 		case BC_KGC_CHILD:
 			constants[i].type = BC_KGC_CHILD;
-			assert(unlinkedPrototypes.size(), "Failed to link child prototype", bytecode.filePath, DEBUG_INFO);
-			constants[i].prototype = unlinkedPrototypes.back();
-			unlinkedPrototypes.pop_back();
 			continue;
 		case BC_KGC_TAB:
 			constants[i].type = BC_KGC_TAB;
@@ -127,7 +136,7 @@ void Bytecode::Prototype::read_constants(std::vector<Prototype*>& unlinkedProtot
 
 void Bytecode::Prototype::read_number_constants() {
 	for (uint32_t i = 0; i < numberConstants.size(); i++) {
-		if (bytecode.fileBuffer[prototypeSize] & 0x01) {
+		if (data[prototypeSize] & 0x01) {
 			numberConstants[i].type = BC_KNUM_NUM;
 			numberConstants[i].number = get_uleb128_33();
 			numberConstants[i].number |= (uint64_t)get_uleb128() << 32;
@@ -142,22 +151,10 @@ void Bytecode::Prototype::read_debug_info() {
 	if (!header.hasDebugInfo) return;
 	lineMap.resize(instructions.size());
 
-	if (header.lineCount < 256) {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-		}
-	} else if (header.lineCount < 65536) {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-			lineMap[i] |= (uint16_t)get_next_byte() << 8;
-		}
+	if (bytecode.header.flags & BC_F_BE) {
+		read_line_map<true>();
 	} else {
-		for (uint32_t i = 0; i < lineMap.size(); i++) {
-			lineMap[i] = get_next_byte();
-			lineMap[i] |= (uint32_t)get_next_byte() << 8;
-			lineMap[i] |= (uint32_t)get_next_byte() << 16;
-			lineMap[i] |= (uint32_t)get_next_byte() << 24;
-		}
+		read_line_map<false>();
 	}
 
 	upvalueNames.resize(upvalues.size());
@@ -196,9 +193,39 @@ void Bytecode::Prototype::read_debug_info() {
 	variableInfos.shrink_to_fit();
 }
 
+template <bool IS_BIG_ENDIAN>
+void Bytecode::Prototype::read_line_map() {
+	if (header.lineCount < 256) {
+		for (uint32_t i = 0; i < lineMap.size(); i++) {
+			lineMap[i] = get_next_byte();
+		}
+	} else if (header.lineCount < 65536) {
+		for (uint32_t i = 0; i < lineMap.size(); i++) {
+			lineMap[i] = get_integer<IS_BIG_ENDIAN, uint16_t>();
+		}
+	} else {
+		for (uint32_t i = 0; i < lineMap.size(); i++) {
+			lineMap[i] = get_integer<IS_BIG_ENDIAN, uint32_t>();
+		}
+	}
+}
+
 uint8_t Bytecode::Prototype::get_next_byte() {
-	assert(prototypeSize < bytecode.fileBuffer.size(), "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
-	return bytecode.fileBuffer[prototypeSize++];
+	assert(prototypeSize < dataSize, "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	return data[prototypeSize++];
+}
+
+template <bool IS_BIG_ENDIAN, typename T>
+T Bytecode::Prototype::get_integer() {
+	assert(dataSize - prototypeSize >= sizeof(T), "Prototype read would exceed end of buffer", bytecode.filePath, DEBUG_INFO);
+	T integer = 0;
+
+	for (uint8_t i = 0; i < sizeof(T); i++) {
+		integer |= (T)data[prototypeSize + i] << (IS_BIG_ENDIAN ? sizeof(T) - 1 - i : i) * 8;
+	}
+
+	prototypeSize += sizeof(T);
+	return integer;
 }
 
 uint32_t Bytecode::Prototype::get_uleb128() {
@@ -1,9 +1,9 @@
-class Bytecode::Prototype {
+class Prototype {
 public:
 
 	Prototype(const Bytecode& bytecode);
 
-	void operator()(std::vector<Prototype*>& unlinkedPrototypes);
+	void operator()(const uint8_t* const& data, const uint32_t& dataSize);
 
 	struct {
 		uint8_t flags = 0;
@@ -21,21 +21,30 @@ public:
 	std::vector<uint32_t> lineMap;
 	std::vector<std::string> upvalueNames;
 	std::vector<VariableInfo> variableInfos;
+	const uint32_t index;
 	uint32_t prototypeSize = 0;
 
 private:
 
 	void read_header();
+	template <bool IS_BIG_ENDIAN>
 	void read_instructions();
+	template <bool IS_BIG_ENDIAN>
 	void read_upvalues();
-	void read_constants(std::vector<Prototype*>& unlinkedPrototypes);
+	void read_constants();
 	void read_number_constants();
 	void read_debug_info();
+	template <bool IS_BIG_ENDIAN>
+	void read_line_map();
 	uint8_t get_next_byte();
+	template <bool IS_BIG_ENDIAN, typename T>
+	T get_integer();
 	uint32_t get_uleb128();
 	uint32_t get_uleb128_33();
 	std::string get_string();
 	TableConstant get_table_constant();
 
 	const Bytecode& bytecode;
+	const uint8_t* data = nullptr;
+	uint32_t dataSize = 0;
 };
@@ -0,0 +1,610 @@
+#include "../main.h"
+
+static constexpr uint16_t LENGTH_BASES[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static constexpr uint8_t LENGTH_EXTRA_BITS[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static constexpr uint16_t DISTANCE_BASES[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static constexpr uint8_t DISTANCE_EXTRA_BITS[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static constexpr uint8_t LENGTH_CODE_ORDER[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static constexpr struct CrcTable {
+	uint32_t values[256];
+
+	constexpr CrcTable() : values() {
+		for (uint32_t i = 0; i < 256; i++) {
+			values[i] = i;
+
+			for (uint8_t j = 8; j--;) {
+				values[i] = values[i] & 1 ? 0xEDB88320 ^ (values[i] >> 1) : values[i] >> 1;
+			}
+		}
+	}
+} CRC_TABLE;
+
+uint32_t update_crc32(const uint32_t& crc, const uint8_t* const& data, const uint64_t& size) {
+	uint32_t value = ~crc;
+
+	for (uint64_t i = 0; i < size; i++) {
+		value = CRC_TABLE.values[(value ^ data[i]) & 0xFF] ^ (value >> 8);
+	}
+
+	return ~value;
+}
+
+template <typename T, size_t N>
+static uint32_t get_code_index(const T (&bases)[N], const uint16_t& value) {
+	return std::upper_bound(bases, bases + N, value) - bases - 1;
+}
+
+Deflate::Deflate() : head(HASH_SIZE, 0), previous(WINDOW_SIZE, 0) {}
+
+void Deflate::write(const uint8_t* const& data, const uint64_t& size) {
+	input.insert(input.end(), data, data + size);
+	if (inputOffset + input.size() - position >= BLOCK_SIZE + MAX_MATCH) compress(false);
+}
+
+void Deflate::finish() {
+	compress(true);
+	if (bitCount) output += (char)bitBuffer;
+	bitBuffer = 0;
+	bitCount = 0;
+}
+
+uint32_t Deflate::get_hash(const uint64_t& position) const {
+	const uint8_t* const data = input.data() + (position - inputOffset);
+	return ((data[0] << 10) ^ (data[1] << 5) ^ data[2]) & (HASH_SIZE - 1);
+}
+
+void Deflate::compress(const bool& isFinal) {
+	const uint64_t end = inputOffset + input.size();
+	const uint64_t limit = isFinal ? end : end - MAX_MATCH;
+	uint32_t length, bestLength, bestDistance, chainLength;
+	uint64_t candidate, match, next;
+	uint32_t maxLength;
+
+	while (position < limit) {
+		bestLength = 0;
+		bestDistance = 0;
+
+		if (end - position >= MIN_MATCH) {
+			const uint32_t hash = get_hash(position);
+			candidate = head[hash];
+			previous[position & (WINDOW_SIZE - 1)] = candidate;
+			head[hash] = position + 1;
+			maxLength = end - position < MAX_MATCH ? end - position : MAX_MATCH;
+			const uint8_t* const data = input.data() + (position - inputOffset);
+
+			for (chainLength = MAX_CHAIN; candidate && chainLength--;) {
+				match = candidate - 1;
+				if (position - match > WINDOW_SIZE) break;
+				const uint8_t* const matchData = input.data() + (match - inputOffset);
+
+				if (matchData[bestLength] == data[bestLength]) {
+					for (length = 0; length < maxLength && matchData[length] == data[length]; length++);
+
+					if (length > bestLength) {
+						bestLength = length;
+						bestDistance = position - match;
+						if (length == maxLength) break;
+					}
+				}
+
+				next = previous[match & (WINDOW_SIZE - 1)];
+				if (next >= candidate) break;
+				candidate = next;
+			}
+		}
+
+		if (bestLength < MIN_MATCH) {
+			tokens.emplace_back(Token{ .length = input[position - inputOffset], .distance = 0 });
+			position++;
+		} else {
+			tokens.emplace_back(Token{ .length = (uint16_t)bestLength, .distance = (uint16_t)bestDistance });
+			position++;
+
+			for (length = bestLength - 1; length--; position++) {
+				if (end - position < MIN_MATCH) continue;
+				const uint32_t hash = get_hash(position);
+				previous[position & (WINDOW_SIZE - 1)] = head[hash];
+				head[hash] = position + 1;
+			}
+		}
+
+		if (tokens.size() >= BLOCK_SIZE) write_block(false);
+	}
+
+	if (isFinal) {
+		write_block(true);
+	} else if (tokens.size()) {
+		write_block(false);
+	}
+
+	if (position - inputOffset <= WINDOW_SIZE) return;
+	const uint64_t discardSize = position - inputOffset - WINDOW_SIZE;
+	input.erase(input.begin(), input.begin() + discardSize);
+	inputOffset += discardSize;
+}
+
+void Deflate::write_block(const bool& isFinal) {
+	uint32_t literalFrequencies[LITERAL_CODES] = {};
+	uint32_t distanceFrequencies[DISTANCE_CODES] = {};
+
+	for (uint32_t i = tokens.size(); i--;) {
+		if (!tokens[i].distance) {
+			literalFrequencies[tokens[i].length]++;
+			continue;
+		}
+
+		literalFrequencies[END_OF_BLOCK + 1 + get_code_index(LENGTH_BASES, tokens[i].length)]++;
+		distanceFrequencies[get_code_index(DISTANCE_BASES, tokens[i].distance)]++;
+	}
+
+	literalFrequencies[END_OF_BLOCK]++;
+	if (!literalFrequencies[0]) literalFrequencies[0]++;
+	if (!distanceFrequencies[0]) distanceFrequencies[0]++;
+	if (!distanceFrequencies[1]) distanceFrequencies[1]++;
+	uint8_t literalLengths[LITERAL_CODES];
+	uint8_t distanceLengths[DISTANCE_CODES];
+	uint16_t literalCodes[LITERAL_CODES];
+	uint16_t distanceCodes[DISTANCE_CODES];
+	build_code_lengths(literalFrequencies, literalLengths, LITERAL_CODES, 15);
+	build_code_lengths(distanceFrequencies, distanceLengths, DISTANCE_CODES, 15);
+	build_codes(literalLengths, literalCodes, LITERAL_CODES);
+	build_codes(distanceLengths, distanceCodes, DISTANCE_CODES);
+	uint32_t literalCount = LITERAL_CODES;
+	while (!literalLengths[literalCount - 1]) literalCount--;
+	uint32_t distanceCount = DISTANCE_CODES;
+	while (!distanceLengths[distanceCount - 1]) distanceCount--;
+
+	uint8_t codeLengths[LITERAL_CODES + DISTANCE_CODES];
+	const uint32_t codeLengthCount = literalCount + distanceCount;
+	std::memcpy(codeLengths, literalLengths, literalCount);
+	std::memcpy(codeLengths + literalCount, distanceLengths, distanceCount);
+	std::vector<Token> lengthTokens;
+	uint32_t lengthFrequencies[LENGTH_CODES] = {};
+	uint32_t runLength, repeatCount;
+
+	for (uint32_t i = 0; i < codeLengthCount; i += runLength) {
+		for (runLength = 1; i + runLength < codeLengthCount && codeLengths[i + runLength] == codeLengths[i]; runLength++);
+		repeatCount = runLength;
+
+		if (!codeLengths[i]) {
+			for (; repeatCount >= 11; repeatCount -= lengthTokens.back().distance + 11) {
+				lengthTokens.emplace_back(Token{ .length = 18, .distance = (uint16_t)((repeatCount < 138 ? repeatCount : 138) - 11) });
+				lengthFrequencies[18]++;
+			}
+
+			if (repeatCount >= 3) {
+				lengthTokens.emplace_back(Token{ .length = 17, .distance = (uint16_t)(repeatCount - 3) });
+				lengthFrequencies[17]++;
+				repeatCount = 0;
+			}
+		} else {
+			lengthTokens.emplace_back(Token{ .length = codeLengths[i], .distance = 0 });
+			lengthFrequencies[codeLengths[i]]++;
+			repeatCount--;
+
+			for (; repeatCount >= 3; repeatCount -= lengthTokens.back().distance + 3) {
+				lengthTokens.emplace_back(Token{ .length = 16, .distance = (uint16_t)((repeatCount < 6 ? repeatCount : 6) - 3) });
+				lengthFrequencies[16]++;
+			}
+		}
+
+		for (; repeatCount; repeatCount--) {
+			lengthTokens.emplace_back(Token{ .length = codeLengths[i], .distance = 0 });
+			lengthFrequencies[codeLengths[i]]++;
+		}
+	}
+
+	uint8_t lengthLengths[LENGTH_CODES];
+	uint16_t lengthCodes[LENGTH_CODES];
+	build_code_lengths(lengthFrequencies, lengthLengths, LENGTH_CODES, 7);
+	build_codes(lengthLengths, lengthCodes, LENGTH_CODES);
+	uint32_t lengthCount = LENGTH_CODES;
+	while (lengthCount > 4 && !lengthLengths[LENGTH_CODE_ORDER[lengthCount - 1]]) lengthCount--;
+
+	write_bits(isFinal, 1);
+	write_bits(2, 2);
+	write_bits(literalCount - 257, 5);
+	write_bits(distanceCount - 1, 5);
+	write_bits(lengthCount - 4, 4);
+
+	for (uint32_t i = 0; i < lengthCount; i++) {
+		write_bits(lengthLengths[LENGTH_CODE_ORDER[i]], 3);
+	}
+
+	for (uint32_t i = 0; i < lengthTokens.size(); i++) {
+		write_bits(lengthCodes[lengthTokens[i].length], lengthLengths[lengthTokens[i].length]);
+
+		switch (lengthTokens[i].length) {
+		case 16:
+			write_bits(lengthTokens[i].distance, 2);
+			continue;
+		case 17:
+			write_bits(lengthTokens[i].distance, 3);
+			continue;
+		case 18:
+			write_bits(lengthTokens[i].distance, 7);
+			continue;
+		}
+	}
+
+	uint32_t code;
+
+	for (uint32_t i = 0; i < tokens.size(); i++) {
+		if (!tokens[i].distance) {
+			write_bits(literalCodes[tokens[i].length], literalLengths[tokens[i].length]);
+			continue;
+		}
+
+		code = get_code_index(LENGTH_BASES, tokens[i].length);
+		write_bits(literalCodes[END_OF_BLOCK + 1 + code], literalLengths[END_OF_BLOCK + 1 + code]);
+		write_bits(tokens[i].length - LENGTH_BASES[code], LENGTH_EXTRA_BITS[code]);
+		code = get_code_index(DISTANCE_BASES, tokens[i].distance);
+		write_bits(distanceCodes[code], distanceLengths[code]);
+		write_bits(tokens[i].distance - DISTANCE_BASES[code], DISTANCE_EXTRA_BITS[code]);
+	}
+
+	write_bits(literalCodes[END_OF_BLOCK], literalLengths[END_OF_BLOCK]);
+	tokens.clear();
+}
+
+void Deflate::write_bits(const uint32_t& value, const uint8_t& size) {
+	bitBuffer |= (uint64_t)value << bitCount;
+	bitCount += size;
+
+	while (bitCount >= 8) {
+		output += (char)bitBuffer;
+		bitBuffer >>= 8;
+		bitCount -= 8;
+	}
+}
+
+void Deflate::build_code_lengths(const uint32_t* const& frequencies, uint8_t* const& lengths, const uint32_t& count, const uint8_t& maxLength) {
+	std::vector<uint32_t> weights(frequencies, frequencies + count);
+	std::vector<std::pair<uint64_t, uint32_t>> heap;
+	std::vector<uint32_t> parents(count * 2);
+	std::vector<uint8_t> depths(count * 2);
+	const auto compare = [](const std::pair<uint64_t, uint32_t>& left, const std::pair<uint64_t, uint32_t>& right) { return left > right; };
+	uint32_t nodeCount;
+	uint8_t maxDepth;
+
+	while (true) {
+		heap.clear();
+		std::memset(lengths, 0, count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			if (weights[i]) heap.emplace_back(weights[i], i);
+		}
+
+		if (heap.size() == 1) {
+			lengths[heap.front().second] = 1;
+			return;
+		}
+
+		std::make_heap(heap.begin(), heap.end(), compare);
+
+		for (nodeCount = count; heap.size() > 1; nodeCount++) {
+			std::pop_heap(heap.begin(), heap.end(), compare);
+			const std::pair<uint64_t, uint32_t> left = heap.back();
+			heap.pop_back();
+			std::pop_heap(heap.begin(), heap.end(), compare);
+			const std::pair<uint64_t, uint32_t> right = heap.back();
+			heap.back() = { left.first + right.first, nodeCount };
+			std::push_heap(heap.begin(), heap.end(), compare);
+			parents[left.second] = nodeCount;
+			parents[right.second] = nodeCount;
+		}
+
+		depths[nodeCount - 1] = 0;
+		maxDepth = 0;
+
+		for (uint32_t i = nodeCount - 1; i-- > count;) {
+			depths[i] = depths[parents[i]] + 1;
+		}
+
+		for (uint32_t i = count; i--;) {
+			if (!weights[i]) continue;
+			depths[i] = depths[parents[i]] + 1;
+			lengths[i] = depths[i];
+			if (depths[i] > maxDepth) maxDepth = depths[i];
+		}
+
+		if (maxDepth <= maxLength) return;
+
+		for (uint32_t i = count; i--;) {
+			if (weights[i]) weights[i] = (weights[i] >> 1) | 1;
+		}
+	}
+}
+
+void Deflate::build_codes(const uint8_t* const& lengths, uint16_t* const& codes, const uint32_t& count) {
+	uint16_t lengthCounts[16] = {};
+	uint16_t nextCodes[16];
+
+	for (uint32_t i = count; i--;) {
+		lengthCounts[lengths[i]]++;
+	}
+
+	lengthCounts[0] = 0;
+	uint16_t code = 0;
+
+	for (uint8_t i = 1; i < 16; i++) {
+		code = (code + lengthCounts[i - 1]) << 1;
+		nextCodes[i] = code;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		codes[i] = 0;
+		if (!lengths[i]) continue;
+		code = nextCodes[lengths[i]]++;
+
+		for (uint8_t j = lengths[i]; j--; code >>= 1) {
+			codes[i] = (codes[i] << 1) | (code & 1);
+		}
+	}
+}
+
+void Inflate::begin(const uint8_t* const& data, const uint64_t& size) {
+	this->data = data;
+	this->size = size;
+	inputPosition = 0;
+	bitBuffer = 0;
+	bitCount = 0;
+	output.clear();
+	outputPosition = 0;
+	blockType = BLOCK_HEADER;
+	isFinalBlock = false;
+	storedSize = 0;
+}
+
+bool Inflate::read(uint8_t* const& buffer, const uint64_t& byteCount) {
+	uint64_t chunkSize;
+
+	for (uint64_t offset = 0; offset < byteCount; offset += chunkSize) {
+		chunkSize = byteCount - offset < DECODE_SIZE ? byteCount - offset : DECODE_SIZE;
+		if (!fill_output(chunkSize)) return false;
+		if (buffer) std::memcpy(buffer + offset, output.data() + outputPosition, chunkSize);
+		outputPosition += chunkSize;
+		if (outputPosition <= WINDOW_SIZE * 4) continue;
+		output.erase(output.begin(), output.begin() + (outputPosition - WINDOW_SIZE));
+		outputPosition = WINDOW_SIZE;
+	}
+
+	return true;
+}
+
+bool Inflate::skip(const uint64_t& byteCount) {
+	return read(nullptr, byteCount);
+}
+
+bool Inflate::fill_output(const uint64_t& byteCount) {
+	while (output.size() - outputPosition < byteCount) {
+		if (blockType == BLOCK_END || !decode()) {
+			blockType = BLOCK_END;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Inflate::decode() {
+	if (blockType == BLOCK_HEADER) {
+		if (isFinalBlock) return false;
+		isFinalBlock = read_bits(1);
+
+		switch (read_bits(2)) {
+		case 0:
+			read_bits(bitCount & 7);
+			storedSize = read_bits(16);
+			if ((read_bits(16) ^ 0xFFFF) != storedSize) return false;
+			blockType = BLOCK_STORED;
+			break;
+		case 1:
+			{
+				uint8_t lengths[LITERAL_CODES + DISTANCE_CODES];
+				std::memset(lengths, 8, 144);
+				std::memset(lengths + 144, 9, 112);
+				std::memset(lengths + 256, 7, 24);
+				std::memset(lengths + 280, 8, 8);
+				std::memset(lengths + LITERAL_CODES, 5, DISTANCE_CODES);
+				build_huffman(literals, lengths, LITERAL_CODES);
+				build_huffman(distances, lengths + LITERAL_CODES, DISTANCE_CODES);
+			}
+
+			blockType = BLOCK_HUFFMAN;
+			break;
+		case 2:
+			if (!read_dynamic_tables()) return false;
+			blockType = BLOCK_HUFFMAN;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	if (blockType == BLOCK_STORED) {
+		for (uint32_t i = storedSize < DECODE_SIZE ? storedSize : DECODE_SIZE; i--; storedSize--) {
+			output.emplace_back(read_bits(8));
+		}
+
+		if (!storedSize) blockType = BLOCK_HEADER;
+		return !is_input_exhausted();
+	}
+
+	const uint64_t targetSize = output.size() + DECODE_SIZE;
+	int32_t symbol;
+	uint32_t length, distance;
+
+	while (output.size() < targetSize) {
+		symbol = read_symbol(literals);
+		if (symbol < 0) return false;
+
+		if (symbol < END_OF_BLOCK) {
+			output.emplace_back(symbol);
+			continue;
+		}
+
+		if (symbol == END_OF_BLOCK) {
+			blockType = BLOCK_HEADER;
+			break;
+		}
+
+		symbol -= END_OF_BLOCK + 1;
+		if (symbol >= (int32_t)std::size(LENGTH_BASES)) return false;
+		length = LENGTH_BASES[symbol] + read_bits(LENGTH_EXTRA_BITS[symbol]);
+		symbol = read_symbol(distances);
+		if (symbol < 0 || symbol >= (int32_t)std::size(DISTANCE_BASES)) return false;
+		distance = DISTANCE_BASES[symbol] + read_bits(DISTANCE_EXTRA_BITS[symbol]);
+		if (distance > output.size()) return false;
+
+		for (uint64_t i = output.size() - distance; length--; i++) {
+			output.emplace_back(output[i]);
+		}
+	}
+
+	return !is_input_exhausted();
+}
+
+bool Inflate::read_dynamic_tables() {
+	const uint32_t literalCount = read_bits(5) + 257;
+	const uint32_t distanceCount = read_bits(5) + 1;
+	const uint32_t lengthCount = read_bits(4) + 4;
+	uint8_t lengths[LITERAL_CODES + DISTANCE_CODES] = {};
+
+	for (uint32_t i = 0; i < lengthCount; i++) {
+		lengths[LENGTH_CODE_ORDER[i]] = read_bits(3);
+	}
+
+	if (literalCount > 286 || distanceCount > DISTANCE_CODES || !build_huffman(literals, lengths, LENGTH_CODES)) return false;
+	int32_t symbol;
+	uint32_t repeatCount;
+	uint8_t repeatLength;
+
+	for (uint32_t i = 0; i < literalCount + distanceCount;) {
+		symbol = read_symbol(literals);
+		if (symbol < 0) return false;
+
+		if (symbol < 16) {
+			lengths[i++] = symbol;
+			continue;
+		}
+
+		switch (symbol) {
+		case 16:
+			if (!i) return false;
+			repeatLength = lengths[i - 1];
+			repeatCount = read_bits(2) + 3;
+			break;
+		case 17:
+			repeatLength = 0;
+			repeatCount = read_bits(3) + 3;
+			break;
+		default:
+			repeatLength = 0;
+			repeatCount = read_bits(7) + 11;
+			break;
+		}
+
+		if (i + repeatCount > literalCount + distanceCount) return false;
+
+		for (; repeatCount--; i++) {
+			lengths[i] = repeatLength;
+		}
+	}
+
+	return lengths[END_OF_BLOCK] && build_huffman(literals, lengths, literalCount) && build_huffman(distances, lengths + literalCount, distanceCount) && !is_input_exhausted();
+}
+
+bool Inflate::is_input_exhausted() const {
+	return inputPosition * 8 - bitCount > size * 8;
+}
+
+void Inflate::fill_bits() {
+	for (; bitCount <= 56; bitCount += 8, inputPosition++) {
+		if (inputPosition < size) bitBuffer |= (uint64_t)data[inputPosition] << bitCount;
+	}
+}
+
+uint32_t Inflate::read_bits(const uint8_t& count) {
+	if (bitCount < count) fill_bits();
+	const uint32_t value = bitBuffer & ((1ull << count) - 1);
+	bitBuffer >>= count;
+	bitCount -= count;
+	return value;
+}
+
+int32_t Inflate::read_symbol(const Huffman& huffman) {
+	if (bitCount < 15) fill_bits();
+	const uint16_t fastSymbol = huffman.fastSymbols[bitBuffer & ((1 << FAST_BITS) - 1)];
+
+	if (fastSymbol) {
+		bitBuffer >>= fastSymbol & 15;
+		bitCount -= fastSymbol & 15;
+		return fastSymbol >> 4;
+	}
+
+	int32_t code = 0;
+	int32_t first = 0;
+	int32_t index = 0;
+
+	for (uint8_t i = 1; i < 16; i++) {
+		code |= (bitBuffer >> (i - 1)) & 1;
+
+		if (code - first < huffman.counts[i]) {
+			bitBuffer >>= i;
+			bitCount -= i;
+			return huffman.symbols[index + code - first];
+		}
+
+		index += huffman.counts[i];
+		first = (first + huffman.counts[i]) << 1;
+		code <<= 1;
+	}
+
+	return -1;
+}
+
+bool Inflate::build_huffman(Huffman& huffman, const uint8_t* const& lengths, const uint32_t& count) {
+	uint16_t offsets[16];
+	uint16_t nextCodes[16];
+	std::memset(huffman.counts, 0, sizeof(huffman.counts));
+	std::memset(huffman.fastSymbols, 0, sizeof(huffman.fastSymbols));
+
+	for (uint32_t i = count; i--;) {
+		huffman.counts[lengths[i]]++;
+	}
+
+	huffman.counts[0] = 0;
+	int32_t remainingCodes = 1;
+	offsets[1] = 0;
+	nextCodes[1] = 0;
+
+	for (uint8_t i = 1; i < 16; i++) {
+		remainingCodes = (remainingCodes << 1) - huffman.counts[i];
+		if (remainingCodes < 0) return false;
+		if (i == 15) break;
+		offsets[i + 1] = offsets[i] + huffman.counts[i];
+		nextCodes[i + 1] = (nextCodes[i] + huffman.counts[i]) << 1;
+	}
+
+	uint16_t code, reversedCode;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (!lengths[i]) continue;
+		huffman.symbols[offsets[lengths[i]]++] = i;
+		code = nextCodes[lengths[i]]++;
+		if (lengths[i] > FAST_BITS) continue;
+		reversedCode = 0;
+
+		for (uint8_t j = lengths[i]; j--; code >>= 1) {
+			reversedCode = (reversedCode << 1) | (code & 1);
+		}
+
+		for (uint32_t j = reversedCode; j < (1 << FAST_BITS); j += 1 << lengths[i]) {
+			huffman.fastSymbols[j] = (i << 4) | lengths[i];
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,101 @@
+uint32_t update_crc32(const uint32_t& crc, const uint8_t* const& data, const uint64_t& size);
+
+class Deflate {
+public:
+
+	Deflate();
+
+	void write(const uint8_t* const& data, const uint64_t& size);
+	void finish();
+
+	std::string output;
+
+private:
+
+	static constexpr uint32_t WINDOW_SIZE = 0x8000;
+	static constexpr uint32_t HASH_SIZE = 0x8000;
+	static constexpr uint32_t MIN_MATCH = 3;
+	static constexpr uint32_t MAX_MATCH = 258;
+	static constexpr uint32_t MAX_CHAIN = 32;
+	static constexpr uint32_t BLOCK_SIZE = 0x10000;
+	static constexpr uint32_t LITERAL_CODES = 286;
+	static constexpr uint32_t DISTANCE_CODES = 30;
+	static constexpr uint32_t LENGTH_CODES = 19;
+	static constexpr uint32_t END_OF_BLOCK = 256;
+
+	struct Token {
+		uint16_t length;
+		uint16_t distance;
+	};
+
+	void compress(const bool& isFinal);
+	void write_block(const bool& isFinal);
+	void write_bits(const uint32_t& value, const uint8_t& size);
+	uint32_t get_hash(const uint64_t& position) const;
+
+	static void build_code_lengths(const uint32_t* const& frequencies, uint8_t* const& lengths, const uint32_t& count, const uint8_t& maxLength);
+	static void build_codes(const uint8_t* const& lengths, uint16_t* const& codes, const uint32_t& count);
+
+	std::vector<uint8_t> input;
+	uint64_t inputOffset = 0;
+	uint64_t position = 0;
+	std::vector<uint64_t> head;
+	std::vector<uint64_t> previous;
+	std::vector<Token> tokens;
+	uint64_t bitBuffer = 0;
+	uint8_t bitCount = 0;
+};
+
+class Inflate {
+public:
+
+	void begin(const uint8_t* const& data, const uint64_t& size);
+	bool read(uint8_t* const& buffer, const uint64_t& byteCount);
+	bool skip(const uint64_t& byteCount);
+
+private:
+
+	static constexpr uint32_t WINDOW_SIZE = 0x8000;
+	static constexpr uint32_t DECODE_SIZE = 0x10000;
+	static constexpr uint8_t FAST_BITS = 10;
+	static constexpr uint32_t LITERAL_CODES = 288;
+	static constexpr uint32_t DISTANCE_CODES = 30;
+	static constexpr uint32_t LENGTH_CODES = 19;
+	static constexpr int32_t END_OF_BLOCK = 256;
+
+	enum BLOCK_TYPE {
+		BLOCK_HEADER,
+		BLOCK_STORED,
+		BLOCK_HUFFMAN,
+		BLOCK_END
+	};
+
+	struct Huffman {
+		uint16_t counts[16];
+		uint16_t symbols[LITERAL_CODES];
+		uint16_t fastSymbols[1 << FAST_BITS];
+	};
+
+	bool fill_output(const uint64_t& byteCount);
+	bool decode();
+	bool read_dynamic_tables();
+	bool is_input_exhausted() const;
+	uint32_t read_bits(const uint8_t& count);
+	int32_t read_symbol(const Huffman& huffman);
+	void fill_bits();
+
+	static bool build_huffman(Huffman& huffman, const uint8_t* const& lengths, const uint32_t& count);
+
+	const uint8_t* data = nullptr;
+	uint64_t size = 0;
+	uint64_t inputPosition = 0;
+	uint64_t bitBuffer = 0;
+	uint8_t bitCount = 0;
+	std::vector<uint8_t> output;
+	uint64_t outputPosition = 0;
+	BLOCK_TYPE blockType = BLOCK_END;
+	bool isFinalBlock = false;
+	uint32_t storedSize = 0;
+	Huffman literals;
+	Huffman distances;
+};
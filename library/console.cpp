@@ -0,0 +1,7 @@
+#include "../main.h"
+
+void print(const std::string&) {}
+
+void print_progress_bar(const double&, const double&) {}
+
+void erase_progress_bar() {}
@@ -0,0 +1,99 @@
+#include "../main.h"
+
+static char* copy_string(const std::string& string) {
+	char* const copy = (char*)std::malloc(string.size() + 1);
+	if (copy) std::memcpy(copy, string.c_str(), string.size() + 1);
+	return copy;
+}
+
+std::string luajit_decompiler::decompile(const uint8_t* data, size_t size, const DecompilerOptions& options, const std::string& name) {
+	struct Decompilation {
+		const uint8_t* const data;
+		const size_t size;
+		const DecompilerOptions& options;
+		const std::string& name;
+		std::string source;
+		std::exception_ptr exception;
+	} decompilation = { .data = data, .size = size, .options = options, .name = name, .source = {}, .exception = {} };
+
+	run_large_stack_thread([](void* const& argument) {
+		Decompilation& decompilation = *(Decompilation*)argument;
+
+		try {
+			Bytecode bytecode(decompilation.name, decompilation.data, decompilation.size);
+			Ast ast(bytecode, decompilation.options.ignoreDebugInfo, decompilation.options.minimizeDiffs, false, nullptr);
+			Lua lua(bytecode, ast, decompilation.name, decompilation.options.minimizeDiffs, decompilation.options.unrestrictedAscii, 1, nullptr);
+			bytecode();
+			ast();
+			lua();
+			decompilation.source = std::move(lua.source);
+		} catch (const ::Error& error) {
+			decompilation.exception = std::make_exception_ptr(Error{
+				.message = error.message,
+				.filePath = error.filePath,
+				.function = error.function,
+				.source = error.source,
+				.line = (uint32_t)std::strtoul(error.line.c_str(), nullptr, 10)
+			});
+		} catch (...) {
+			decompilation.exception = std::current_exception();
+		}
+	}, &decompilation);
+
+	if (decompilation.exception) std::rethrow_exception(decompilation.exception);
+	return std::move(decompilation.source);
+}
+
+bool luajit_decompile(const uint8_t* data, size_t size, const DecompilerOptions* options, DecompilerResult* result) {
+	static constexpr DecompilerOptions DEFAULT_OPTIONS = {};
+
+	*result = {};
+
+	try {
+		const std::string source = luajit_decompiler::decompile(data, size, options ? *options : DEFAULT_OPTIONS);
+		result->source = copy_string(source);
+		result->sourceSize = source.size();
+		return result->source;
+	} catch (const luajit_decompiler::Error& error) {
+		result->errorMessage = copy_string(error.message);
+		result->errorFilePath = copy_string(error.filePath);
+		result->errorFunction = copy_string(error.function);
+		result->errorSource = copy_string(error.source);
+		result->errorLine = error.line;
+	} catch (...) {
+		result->errorMessage = copy_string("Unknown exception");
+	}
+
+	return false;
+}
+
+void luajit_free_result(DecompilerResult* result) {
+	std::free(result->source);
+	std::free(result->errorMessage);
+	std::free(result->errorFilePath);
+	std::free(result->errorFunction);
+	std::free(result->errorSource);
+	*result = {};
+}
+
+void assert(const bool& assertion, const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line) {
+	if (!assertion) throw Error{
+		.message = message,
+		.filePath = filePath,
+		.function = function,
+		.source = source,
+		.line = std::to_string(line)
+	};
+}
+
+std::string byte_to_string(const uint8_t& byte) {
+	char string[] = "0x00";
+	uint8_t digit;
+
+	for (uint8_t i = 2; i--;) {
+		digit = (byte >> i * 4) & 0xF;
+		string[3 - i] = digit >= 0xA ? 'A' + digit - 0xA : '0' + digit;
+	}
+
+	return string;
+}
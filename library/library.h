@@ -0,0 +1,59 @@
+#ifndef LUAJIT_DECOMPILER_LIBRARY_H
+#define LUAJIT_DECOMPILER_LIBRARY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifdef LUAJIT_DECOMPILER_BUILD
+#define LUAJIT_DECOMPILER_API __declspec(dllexport)
+#else
+#define LUAJIT_DECOMPILER_API __declspec(dllimport)
+#endif
+#else
+#define LUAJIT_DECOMPILER_API __attribute__((visibility("default")))
+#endif
+
+typedef struct DecompilerOptions {
+	bool ignoreDebugInfo;
+	bool minimizeDiffs;
+	bool unrestrictedAscii;
+} DecompilerOptions;
+
+typedef struct DecompilerResult {
+	char* source;
+	size_t sourceSize;
+	char* errorMessage;
+	char* errorFilePath;
+	char* errorFunction;
+	char* errorSource;
+	uint32_t errorLine;
+} DecompilerResult;
+
+#ifdef __cplusplus
+#include <string>
+
+namespace luajit_decompiler {
+	struct LUAJIT_DECOMPILER_API Error {
+		std::string message;
+		std::string filePath;
+		std::string function;
+		std::string source;
+		uint32_t line;
+	};
+
+	LUAJIT_DECOMPILER_API std::string decompile(const uint8_t* data, size_t size, const DecompilerOptions& options, const std::string& name = "");
+}
+
+extern "C" {
+#endif
+
+LUAJIT_DECOMPILER_API bool luajit_decompile(const uint8_t* data, size_t size, const DecompilerOptions* options, DecompilerResult* result);
+LUAJIT_DECOMPILER_API void luajit_free_result(DecompilerResult* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
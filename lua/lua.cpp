@@ -1,22 +1,21 @@
-#include "..\main.h"
+#include "../main.h"
 
-Lua::Lua(const Bytecode& bytecode, const Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii)
-	: bytecode(bytecode), ast(ast), filePath(filePath), forceOverwrite(forceOverwrite), minimizeDiffs(minimizeDiffs), unrestrictedAscii(unrestrictedAscii) {}
+Lua::Lua(const Bytecode& bytecode, Ast& ast, const std::string& filePath, const bool& minimizeDiffs, const bool& unrestrictedAscii, const uint32_t& threadCount, FileWriter* const& writer)
+	: bytecode(bytecode), ast(ast), filePath(filePath), minimizeDiffs(minimizeDiffs), unrestrictedAscii(unrestrictedAscii), threadCount(threadCount), writer(writer) {}
 
-Lua::~Lua() {
-	close_file();
-}
+const Lua::CleanByteCounter Lua::get_clean_byte_count = Lua::get_clean_byte_counter();
 
 void Lua::operator()() {
+	TRACE_SCOPE("Lua::operator()");
+	const Ast::Binding binding(ast);
 	print_progress_bar();
 	prototypeDataLeft = bytecode.prototypesTotalSize;
 	write_header();
 	if (ast.chunk->block.size()) write_block(*ast.chunk, ast.chunk->block);
+	if (functionDefinitions.size()) write_function_definitions();
 	prototypeDataLeft -= ast.chunk->prototype.prototypeSize;
 	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
-	create_file();
 	write_file();
-	close_file();
 	erase_progress_bar();
 }
 
@@ -28,8 +27,8 @@ void Lua::write_header() {
 	write(NEW_LINE, NEW_LINE);
 }
 
-void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Statement*>& block) {
-	std::vector<Ast::Statement*>* elseBlock;
+void Lua::write_block(const Ast::Function& function, const std::vector<Ast::StatementIndex>& block) {
+	std::vector<Ast::StatementIndex>* elseBlock;
 	bool isFunctionDefinition;
 	bool previousLineIsEmpty = true;
 
@@ -40,6 +39,8 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 	}
 
 	for (uint32_t i = 0; i < block.size(); i++) {
+		if (!function.level) ast.release_functions();
+
 		if (!previousLineIsEmpty) {
 			switch (block[i - 1]->type) {
 			case Ast::AST_STATEMENT_RETURN:
@@ -136,18 +137,19 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 			if (block[i]->assignment.variables.size() == 1
 				&& block[i]->assignment.expressions.size() == 1
 				&& block[i]->assignment.expressions.back()->type == Ast::AST_EXPRESSION_FUNCTION) {
+				ast.build_function(*block[i]->assignment.expressions.back()->function);
 				isFunctionDefinition = true;
 
 				if (!block[i]->assignment.expressions.back()->function->assignmentSlotIsUpvalue) {
 					for (uint8_t j = block[i]->assignment.expressions.back()->function->upvalues.size(); j--;) {
-						if ((*block[i]->assignment.expressions.back()->function->upvalues[j].slotScope)->name != (*block[i]->assignment.variables.back().slotScope)->name) continue;
+						if (block[i]->assignment.expressions.back()->function->upvalues[j].slotScope->slotScope->name != block[i]->assignment.variables.back().slotScope->slotScope->name) continue;
 						isFunctionDefinition = false;
 						break;
 					}
 
 					if (isFunctionDefinition) {
 						for (uint32_t j = block[i]->assignment.expressions.back()->function->usedGlobals.size(); j--;) {
-							if (*block[i]->assignment.expressions.back()->function->usedGlobals[j] != (*block[i]->assignment.variables.back().slotScope)->name) continue;
+							if (*block[i]->assignment.expressions.back()->function->usedGlobals[j] != block[i]->assignment.variables.back().slotScope->slotScope->name) continue;
 							isFunctionDefinition = false;
 							break;
 						}
@@ -199,6 +201,7 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 			}
 
 			if (isFunctionDefinition) {
+				ast.build_function(*block[i]->assignment.expressions.back()->function);
 				if (!previousLineIsEmpty) write(NEW_LINE);
 				write_indent();
 
@@ -330,7 +333,7 @@ void Lua::write_block(const Ast::Function& function, const std::vector<Ast::Stat
 }
 
 void Lua::write_expression(const Ast::Expression& expression, const bool& useParentheses) {
-	uint32_t nextListIndex, nextFieldIndex;
+	uint32_t nextListIndex, nextFieldIndex, constantListSize;
 	uint8_t operatorPrecedence, operandPrecedence;
 	bool parentheses, isFirstField, isFieldFound;
 	if (useParentheses) write("(");
@@ -372,6 +375,7 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 		write("...");
 		break;
 	case Ast::AST_EXPRESSION_FUNCTION:
+		ast.build_function(*expression.function);
 		write("function ");
 		write_function_definition(*expression.function, false);
 		break;
@@ -382,8 +386,10 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 		write_function_call(*expression.functionCall, false);
 		break;
 	case Ast::AST_EXPRESSION_TABLE:
-		if (!expression.table->constants.list.size()
-			&& !expression.table->constants.fields.size()
+		constantListSize = expression.table->constants.table ? expression.table->constants.table->array.size() : 0;
+
+		if (!constantListSize
+			&& !expression.table->constants.fieldCount
 			&& !expression.table->fields.size()
 			&& !expression.table->multresField) {
 			write("{}");
@@ -397,20 +403,20 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 		nextFieldIndex = 0;
 		isFirstField = true;
 
-		if (expression.table->constants.list.size() && expression.table->constants.list.front()->constant->type != Ast::AST_CONSTANT_NIL) {
+		if (constantListSize && expression.table->constants.table->array.front().type != Bytecode::BC_KTAB_NIL) {
 			write("[0] = ");
-			write_expression(*expression.table->constants.list.front(), false);
+			write_table_constant(expression.table->constants.table->array.front());
 			isFirstField = false;
 		}
 
 		while (!expression.table->multresField || nextListIndex < expression.table->multresIndex) {
-			if (nextListIndex < expression.table->constants.list.size() && expression.table->constants.list[nextListIndex]->constant->type != Ast::AST_CONSTANT_NIL) {
+			if (nextListIndex < constantListSize && expression.table->constants.table->array[nextListIndex].type != Bytecode::BC_KTAB_NIL) {
 				if (!isFirstField) {
 					write(",", NEW_LINE);
 					write_indent();
 				}
 
-				write_expression(*expression.table->constants.list[nextListIndex], false);
+				write_table_constant(expression.table->constants.table->array[nextListIndex]);
 				isFirstField = false;
 				nextListIndex++;
 				continue;
@@ -456,9 +462,9 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 
 				if (!expression.table->multresField
 					&& nextFieldIndex == expression.table->fields.size() - 1
-					&& !expression.table->constants.fields.size()
-					&& (!expression.table->constants.list.size()
-						|| nextListIndex >= expression.table->constants.list.size() - 1)) {
+					&& !expression.table->constants.fieldCount
+					&& (!constantListSize
+						|| nextListIndex >= constantListSize - 1)) {
 					switch (expression.table->fields.back().value->type) {
 					case Ast::AST_EXPRESSION_VARARG:
 					case Ast::AST_EXPRESSION_FUNCTION_CALL:
@@ -476,7 +482,7 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 
 				write_expression(*expression.table->fields[nextFieldIndex].value, false);
 				nextFieldIndex++;
-			} else if (!expression.table->multresField && nextListIndex >= expression.table->constants.list.size()) {
+			} else if (!expression.table->multresField && nextListIndex >= constantListSize) {
 				break;
 			} else {
 				if (!isFirstField) {
@@ -491,8 +497,8 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 			nextListIndex++;
 		}
 
-		for (uint32_t i = nextListIndex; i < expression.table->constants.list.size(); i++) {
-			if (expression.table->constants.list[i]->constant->type == Ast::AST_CONSTANT_NIL) continue;
+		for (uint32_t i = nextListIndex; i < constantListSize; i++) {
+			if (expression.table->constants.table->array[i].type == Bytecode::BC_KTAB_NIL) continue;
 
 			if (!isFirstField) {
 				write(",", NEW_LINE);
@@ -500,28 +506,11 @@ void Lua::write_expression(const Ast::Expression& expression, const bool& usePar
 			}
 
 			write("[", std::to_string(i), "] = ");
-			write_expression(*expression.table->constants.list[i], false);
+			write_table_constant(expression.table->constants.table->array[i]);
 			isFirstField = false;
 		}
 
-		for (uint32_t i = 0; i < expression.table->constants.fields.size(); i++) {
-			if (!isFirstField) {
-				write(",", NEW_LINE);
-				write_indent();
-			}
-
-			if (expression.table->constants.fields[i].key->constant->isName) {
-				write(expression.table->constants.fields[i].key->constant->string);
-			} else {
-				write("[");
-				write_expression(*expression.table->constants.fields[i].key, false);
-				write("]");
-			}
-
-			write(" = ");
-			write_expression(*expression.table->constants.fields[i].value, false);
-			isFirstField = false;
-		}
+		if (expression.table->constants.fieldCount) write_table_constant_fields(*expression.table, isFirstField);
 
 		for (uint32_t i = nextFieldIndex; i < expression.table->fields.size(); i++) {
 			if (!isFirstField) {
@@ -696,11 +685,11 @@ void Lua::write_variable(const Ast::Variable& variable, const bool& isLineStart)
 	switch (variable.type) {
 	case Ast::AST_VARIABLE_SLOT:
 	case Ast::AST_VARIABLE_UPVALUE:
-		if (!(*variable.slotScope)->name.size()) throw nullptr;
-		write((*variable.slotScope)->name);
+		if (!variable.slotScope->slotScope->name.size()) throw nullptr;
+		write(variable.slotScope->slotScope->name);
 		break;
 	case Ast::AST_VARIABLE_GLOBAL:
-		write(variable.name);
+		write(*variable.name);
 		break;
 	case Ast::AST_VARIABLE_TABLE_INDEX:
 		write_prefix_expression(*variable.table, isLineStart);
@@ -730,7 +719,7 @@ void Lua::write_function_call(const Ast::FunctionCall& functionCall, const bool&
 	write(")");
 }
 
-void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart) {
+void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::ExpressionIndex>& expressions, const std::string& separator, const bool& isLineStart) {
 	for (uint8_t i = 0; i < variables.size(); i++) {
 		write_variable(variables[i], i ? false : isLineStart);
 		if (i != variables.size() - 1) write(", ");
@@ -769,7 +758,7 @@ void Lua::write_assignment(const std::vector<Ast::Variable>& variables, const st
 	}
 }
 
-void Lua::write_expression_list(const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres) {
+void Lua::write_expression_list(const std::vector<Ast::ExpressionIndex>& expressions, const Ast::Expression* const& multres) {
 	for (uint8_t i = 0; i < expressions.size(); i++) {
 		if (i != expressions.size() - 1 || multres) {
 			write_expression(*expressions[i], false);
@@ -791,6 +780,12 @@ void Lua::write_expression_list(const std::vector<Ast::Expression*>& expressions
 }
 
 void Lua::write_function_definition(const Ast::Function& function, const bool& isMethod) {
+	if (threadCount > 1 && function.level == 1) {
+		functionDefinitions.emplace_back(FunctionDefinition{ .function = &function, .isMethod = isMethod, .indentLevel = indentLevel, .offset = writeBuffer.size(), .source = {} });
+		return;
+	}
+
+	TRACE_SCOPE_ID("Lua::write_function_definition", function.id, function.prototype.prototypeSize);
 	write("(");
 
 	for (uint8_t i = isMethod ? 1 : 0; i < function.parameterNames.size(); i++) {
@@ -816,41 +811,180 @@ void Lua::write_function_definition(const Ast::Function& function, const bool& i
 	write_indent();
 	write("end");
 	prototypeDataLeft -= function.prototype.prototypeSize;
-	print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
+	if (!isWorker) print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft, bytecode.prototypesTotalSize);
 }
 
-void Lua::write_number(const double& number) {
-	static const auto try_string_to_number = [](const std::string& string, const double& number)->bool {
+void Lua::write_function_definitions() {
+	TRACE_SCOPE("Lua::write_function_definitions");
+	std::vector<LargeStackThread> threads(std::min<uint64_t>(threadCount, functionDefinitions.size()) - 1);
+
+	for (uint32_t i = threads.size(); i--;) {
+		if (!threads[i].start([](void* const& lua) {
+			((Lua*)lua)->write_next_function_definitions(false);
+		}, this)) break;
+	}
+
+	write_next_function_definitions(true);
+
+	for (uint32_t i = threads.size(); i--;) {
+		threads[i].join();
+	}
+
+	if (exception) std::rethrow_exception(exception);
+	prototypeDataLeft -= prototypeDataWritten;
+	uint64_t sourceSize = writeBuffer.size();
+
+	for (uint32_t i = functionDefinitions.size(); i--;) {
+		sourceSize += functionDefinitions[i].source.size();
+	}
+
+	std::string source;
+	source.reserve(sourceSize);
+	uint64_t offset = 0;
+
+	for (uint32_t i = 0; i < functionDefinitions.size(); i++) {
+		source.append(writeBuffer, offset, functionDefinitions[i].offset - offset);
+		source += functionDefinitions[i].source;
+		offset = functionDefinitions[i].offset;
+		functionDefinitions[i].source.clear();
+		functionDefinitions[i].source.shrink_to_fit();
+	}
+
+	source.append(writeBuffer, offset);
+	writeBuffer = std::move(source);
+	functionDefinitions.clear();
+}
+
+void Lua::write_next_function_definitions(const bool& showProgress) {
+	const Ast::Binding binding(ast);
+
+	for (uint32_t i = nextFunctionDefinition++; i < functionDefinitions.size(); i = nextFunctionDefinition++) {
 		try {
-			return std::stod(string) == number;
+			Lua lua(bytecode, ast, filePath, minimizeDiffs, unrestrictedAscii, 1, nullptr);
+			lua.isWorker = true;
+			lua.indentLevel = functionDefinitions[i].indentLevel;
+			lua.prototypeDataLeft = bytecode.prototypesTotalSize;
+			lua.write_function_definition(*functionDefinitions[i].function, functionDefinitions[i].isMethod);
+			functionDefinitions[i].source = std::move(lua.writeBuffer);
+			prototypeDataWritten += bytecode.prototypesTotalSize - lua.prototypeDataLeft;
 		} catch (...) {
-			return false;
+			const std::lock_guard<std::mutex> lock(exceptionMutex);
+			if (!exception) exception = std::current_exception();
+			nextFunctionDefinition = functionDefinitions.size();
+			return;
 		}
-	};
 
-	const uint64_t rawDouble = std::bit_cast<uint64_t>(number);
+		if (showProgress) print_progress_bar(bytecode.prototypesTotalSize - prototypeDataLeft + prototypeDataWritten, bytecode.prototypesTotalSize);
+	}
+}
 
-	if ((rawDouble & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) {
-		write(rawDouble & DOUBLE_SIGN ? "-1e309" : "1e309");
+void Lua::write_table_constant(const Bytecode::TableConstant& constant) {
+	switch (constant.type) {
+	case Bytecode::BC_KTAB_NIL:
+		write("nil");
+		return;
+	case Bytecode::BC_KTAB_FALSE:
+		write("false");
+		return;
+	case Bytecode::BC_KTAB_TRUE:
+		write("true");
+		return;
+	case Bytecode::BC_KTAB_INT:
+		write_number(std::bit_cast<int32_t>(constant.integer));
+		return;
+	case Bytecode::BC_KTAB_NUM:
+		if ((constant.number & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) return write(constant.number & DOUBLE_SIGN ? "-1 / 0" : "1 / 0");
+		write_number(std::bit_cast<double>(constant.number));
+		return;
+	case Bytecode::BC_KTAB_STR:
+		write("\"");
+		write_string(constant.string);
+		write("\"");
 		return;
 	}
+}
+
+void Lua::write_table_constant_fields(const Ast::Table& table, bool& isFirstField) {
+	const auto get_key_order = [](const Bytecode::TableConstant& key)->uint8_t {
+		switch (key.type) {
+		case Bytecode::BC_KTAB_FALSE:
+			return 0;
+		case Bytecode::BC_KTAB_TRUE:
+			return 1;
+		case Bytecode::BC_KTAB_INT:
+		case Bytecode::BC_KTAB_NUM:
+			return 2;
+		}
+
+		return 3;
+	};
+
+	const auto get_key_number = [](const Bytecode::TableConstant& key)->double {
+		return key.type == Bytecode::BC_KTAB_INT ? std::bit_cast<int32_t>(key.integer) : std::bit_cast<double>(key.number);
+	};
+
+	const std::vector<Bytecode::TableNode>& nodes = table.constants.table->table;
+	std::vector<uint32_t> order;
+	order.reserve(table.constants.fieldCount);
+
+	if (minimizeDiffs) {
+		for (uint32_t i = nodes.size(); i--;) {
+			if (table.constants.removedFields.size() && table.constants.removedFields[i]) continue;
+			order.emplace_back(i);
+		}
 
-	std::string string;
-	string.resize(std::snprintf(nullptr, 0, "%1.15g", number));
-	std::snprintf(string.data(), string.size() + 1, "%1.15g", number);
+		std::stable_sort(order.begin(), order.end(), [&](const uint32_t& left, const uint32_t& right)->bool {
+			const uint8_t leftOrder = get_key_order(nodes[left].key);
+			const uint8_t rightOrder = get_key_order(nodes[right].key);
+			if (leftOrder != rightOrder) return leftOrder < rightOrder;
 
-	if (!try_string_to_number(string, number)) {
-		string.resize(std::snprintf(nullptr, 0, "%1.16g", number));
-		std::snprintf(string.data(), string.size() + 1, "%1.16g", number);
+			switch (leftOrder) {
+			case 2:
+				return get_key_number(nodes[left].key) < get_key_number(nodes[right].key);
+			case 3:
+				return nodes[left].key.string.compare(nodes[right].key.string) < 0;
+			}
 
-		if (!try_string_to_number(string, number)) {
-			string.resize(std::snprintf(nullptr, 0, "%1.17g", number));
-			std::snprintf(string.data(), string.size() + 1, "%1.17g", number);
-			assert(try_string_to_number(string, number), "Failed to convert number to valid string", filePath, DEBUG_INFO);
+			return false;
+		});
+	} else {
+		for (uint32_t i = 0; i < nodes.size(); i++) {
+			if (table.constants.removedFields.size() && table.constants.removedFields[i]) continue;
+			order.emplace_back(i);
 		}
 	}
 
-	write(string);
+	for (uint32_t i = 0; i < order.size(); i++) {
+		if (!isFirstField) {
+			write(",", NEW_LINE);
+			write_indent();
+		}
+
+		if (nodes[order[i]].key.type == Bytecode::BC_KTAB_STR && Ast::is_valid_name(nodes[order[i]].key.string)) {
+			write(nodes[order[i]].key.string);
+		} else {
+			write("[");
+			write_table_constant(nodes[order[i]].key);
+			write("]");
+		}
+
+		write(" = ");
+		write_table_constant(nodes[order[i]].value);
+		isFirstField = false;
+	}
+}
+
+void Lua::write_number(const double& number) {
+	const uint64_t rawDouble = std::bit_cast<uint64_t>(number);
+
+	if ((rawDouble & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) {
+		write(rawDouble & DOUBLE_SIGN ? "-1e309" : "1e309");
+		return;
+	}
+
+	const uint64_t size = writeBuffer.size();
+	writeBuffer.resize(size + MAX_NUMBER_SIZE);
+	writeBuffer.resize(format_number(writeBuffer.data() + size, number) - writeBuffer.data());
 }
 
 void Lua::write_string(const std::string& string) {
@@ -859,24 +993,23 @@ void Lua::write_string(const std::string& string) {
 	uint8_t digit;
 
 	for (uint32_t i = 0; i < string.size(); i++) {
+		value = get_clean_byte_count(string.data() + i, string.size() - i, unrestrictedAscii);
+
+		if (value) {
+			writeBuffer.append(string, i, value);
+			i += value;
+			if (i == string.size()) return;
+		}
+
 		value = string[i];
 
 		if (unrestrictedAscii || !(value & 0x80)) {
-			if ((string[i] >= ' '
-					&& string[i] <= '~')
-				|| (unrestrictedAscii
-					&& string[i] >= 0x80)) {
-				switch (string[i]) {
-				case '"':
-				case '\\':
-					writeBuffer += '\\';
-				}
-
+			switch (string[i]) {
+			case '"':
+			case '\\':
+				writeBuffer += '\\';
 				writeBuffer += string[i];
 				continue;
-			}
-
-			switch (string[i]) {
 			case '\a':
 				write("\\a");
 				continue;
@@ -907,8 +1040,7 @@ void Lua::write_string(const std::string& string) {
 				if ((value & 0xC0) == 0x80
 					&& value >= 0xC2A0
 					&& value <= 0xDFBF) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
+					writeBuffer.append(string, i, 2);
 					i++;
 					continue;
 				}
@@ -924,9 +1056,7 @@ void Lua::write_string(const std::string& string) {
 							&& value < 0xEDA080)
 						|| (value > 0xEDBFBF
 							&& value <= 0xEFBFBF))) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
-					writeBuffer += string[i + 2];
+					writeBuffer.append(string, i, 3);
 					i += 2;
 					continue;
 				}
@@ -941,10 +1071,7 @@ void Lua::write_string(const std::string& string) {
 				if ((value & 0xC0C0C0) == 0x808080
 					&& value >= 0xF0908080
 					&& value <= 0xF48FBFBF) {
-					writeBuffer += string[i];
-					writeBuffer += string[i + 1];
-					writeBuffer += string[i + 2];
-					writeBuffer += string[i + 3];
+					writeBuffer.append(string, i, 4);
 					i += 3;
 					continue;
 				}
@@ -960,6 +1087,92 @@ void Lua::write_string(const std::string& string) {
 	}
 }
 
+uint32_t Lua::get_clean_byte_count_scalar(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii) {
+	for (uint32_t i = 0; i < size; i++) {
+		switch (string[i]) {
+		case '"':
+		case '\\':
+			return i;
+		}
+
+		if ((string[i] < ' ' || string[i] > '~') && (!unrestrictedAscii || string[i] < 0x80)) return i;
+	}
+
+	return size;
+}
+
+#ifdef PLATFORM_X86
+TARGET_SSE2 uint32_t Lua::get_clean_byte_count_sse2(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii) {
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tilde = _mm_set1_epi8('~');
+	const __m128i unitSeparator = _mm_set1_epi8(0x1F);
+	const __m128i delete_ = _mm_set1_epi8(0x7F);
+	__m128i bytes;
+	__m128i mask;
+	uint32_t i = 0;
+
+	for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i)) {
+		bytes = _mm_loadu_si128((const __m128i*)(string + i));
+		mask = _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash));
+
+		if (unrestrictedAscii) {
+			mask = _mm_or_si128(mask, _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(bytes, unitSeparator), bytes), _mm_cmpeq_epi8(bytes, delete_)));
+		} else {
+			mask = _mm_or_si128(mask, _mm_or_si128(_mm_cmplt_epi8(bytes, space), _mm_cmpgt_epi8(bytes, tilde)));
+		}
+
+		if (_mm_movemask_epi8(mask)) return i + std::countr_zero((uint32_t)_mm_movemask_epi8(mask));
+	}
+
+	return i + get_clean_byte_count_scalar(string + i, size - i, unrestrictedAscii);
+}
+
+TARGET_AVX2 uint32_t Lua::get_clean_byte_count_avx2(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii) {
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tilde = _mm256_set1_epi8('~');
+	const __m256i unitSeparator = _mm256_set1_epi8(0x1F);
+	const __m256i delete_ = _mm256_set1_epi8(0x7F);
+	__m256i bytes;
+	__m256i mask;
+	uint32_t i = 0;
+
+	for (; i + sizeof(__m256i) <= size; i += sizeof(__m256i)) {
+		bytes = _mm256_loadu_si256((const __m256i*)(string + i));
+		mask = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote), _mm256_cmpeq_epi8(bytes, backslash));
+
+		if (unrestrictedAscii) {
+			mask = _mm256_or_si256(mask, _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(bytes, unitSeparator), bytes), _mm256_cmpeq_epi8(bytes, delete_)));
+		} else {
+			mask = _mm256_or_si256(mask, _mm256_or_si256(_mm256_cmpgt_epi8(space, bytes), _mm256_cmpgt_epi8(bytes, tilde)));
+		}
+
+		if (_mm256_movemask_epi8(mask)) return i + std::countr_zero((uint32_t)_mm256_movemask_epi8(mask));
+	}
+
+	return i + get_clean_byte_count_sse2(string + i, size - i, unrestrictedAscii);
+}
+#endif
+
+Lua::CleanByteCounter Lua::get_clean_byte_counter() {
+#ifdef PLATFORM_X86
+	int cpuInfo[4];
+	get_cpuid(cpuInfo, 0);
+	const int maxLeaf = cpuInfo[0];
+	if (maxLeaf < 1) return get_clean_byte_count_scalar;
+	get_cpuid(cpuInfo, 1);
+	if (!(cpuInfo[3] & 1 << 26)) return get_clean_byte_count_scalar;
+	if (maxLeaf < 7 || !(cpuInfo[2] & 1 << 27) || (get_xcr0() & 0x6) != 0x6) return get_clean_byte_count_sse2;
+	get_cpuid(cpuInfo, 7);
+	return cpuInfo[1] & 1 << 5 ? get_clean_byte_count_avx2 : get_clean_byte_count_sse2;
+#else
+	return get_clean_byte_count_scalar;
+#endif
+}
+
 uint8_t Lua::get_operator_precedence(const Ast::Expression& expression) {
 	switch (expression.type) {
 	case Ast::AST_EXPRESSION_BINARY_OPERATION:
@@ -1008,31 +1221,13 @@ void Lua::write_indent() {
 	return write(std::string(indentLevel, '\t'));
 }
 
-void Lua::create_file() {
-#ifndef _DEBUG
-	if (!forceOverwrite) {
-		file = CreateFileA(filePath.c_str(), GENERIC_READ, NULL, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-
-		if (file != INVALID_HANDLE_VALUE) {
-			close_file();
-			assert(MessageBoxA(NULL, ("The file " + filePath + " already exists.\n\nDo you want to overwrite it?").c_str(), PROGRAM_NAME, MB_ICONWARNING | MB_YESNO | MB_DEFBUTTON2) == IDYES,
-				"File already exists", filePath, DEBUG_INFO);
-		}
+void Lua::write_file() {
+	if (!writer) {
+		source = std::move(writeBuffer);
+		return;
 	}
-#endif
-	file = CreateFileA(filePath.c_str(), GENERIC_WRITE, NULL, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-	assert(file != INVALID_HANDLE_VALUE, "Unable to create file", filePath, DEBUG_INFO);
-}
 
-void Lua::close_file() {
-	if (file == INVALID_HANDLE_VALUE) return;
-	CloseHandle(file);
-	file = INVALID_HANDLE_VALUE;
-}
-
-void Lua::write_file() {
-	DWORD charsWritten = 0;
-	assert(WriteFile(file, writeBuffer.data(), writeBuffer.size(), &charsWritten, NULL) && !(writeBuffer.size() - charsWritten), "Failed writing to file", filePath, DEBUG_INFO);
+	assert(writer->write(filePath, std::move(writeBuffer)), "Failed writing to file", filePath, DEBUG_INFO);
 	writeBuffer.clear();
 	writeBuffer.shrink_to_fit();
 }
@@ -1,45 +1,75 @@
 class Lua {
 public:
 
-	Lua(const Bytecode& bytecode, const Ast& ast, const std::string& filePath, const bool& forceOverwrite, const bool& minimizeDiffs, const bool& unrestrictedAscii);
-	~Lua();
+	Lua(const Bytecode& bytecode, Ast& ast, const std::string& filePath, const bool& minimizeDiffs, const bool& unrestrictedAscii, const uint32_t& threadCount, FileWriter* const& writer);
 
 	void operator()();
 
+	static constexpr uint8_t MAX_NUMBER_SIZE = 24;
+
+	static char* format_number(char* const& buffer, const double& number);
+
 	const std::string filePath;
+	std::string source;
 
 private:
 
 	static constexpr char UTF8_BOM[] = "\xEF\xBB\xBF";
 	static constexpr char NEW_LINE[] = "\r\n";
 
+	typedef uint32_t (*CleanByteCounter)(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii);
+
+	struct FunctionDefinition {
+		const Ast::Function* function = nullptr;
+		bool isMethod = false;
+		uint32_t indentLevel = 0;
+		uint64_t offset = 0;
+		std::string source;
+	};
+
 	void write_header();
-	void write_block(const Ast::Function& function, const std::vector<Ast::Statement*>& block);
+	void write_block(const Ast::Function& function, const std::vector<Ast::StatementIndex>& block);
 	void write_expression(const Ast::Expression& expression, const bool& useParentheses);
 	void write_prefix_expression(const Ast::Expression& expression, const bool& isLineStart);
 	void write_variable(const Ast::Variable& variable, const bool& isLineStart);
 	void write_function_call(const Ast::FunctionCall& functionCall, const bool& isLineStart);
-	void write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::Expression*>& expressions, const std::string& separator, const bool& isLineStart);
-	void write_expression_list(const std::vector<Ast::Expression*>& expressions, const Ast::Expression* const& multres);
+	void write_assignment(const std::vector<Ast::Variable>& variables, const std::vector<Ast::ExpressionIndex>& expressions, const std::string& separator, const bool& isLineStart);
+	void write_expression_list(const std::vector<Ast::ExpressionIndex>& expressions, const Ast::Expression* const& multres);
 	void write_function_definition(const Ast::Function& function, const bool& isMethod);
+	void write_function_definitions();
+	void write_next_function_definitions(const bool& showProgress);
+	void write_table_constant(const Bytecode::TableConstant& constant);
+	void write_table_constant_fields(const Ast::Table& table, bool& isFirstField);
 	void write_number(const double& number);
 	void write_string(const std::string& string);
+	static uint32_t get_clean_byte_count_scalar(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii);
+#ifdef PLATFORM_X86
+	static uint32_t get_clean_byte_count_sse2(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii);
+	static uint32_t get_clean_byte_count_avx2(const char* const& string, const uint32_t& size, const bool& unrestrictedAscii);
+#endif
+	static CleanByteCounter get_clean_byte_counter();
 	uint8_t get_operator_precedence(const Ast::Expression& expression);
 	void write(const std::string& string);
 	template <typename... Strings>
 	void write(const std::string& string, const Strings&... strings);
 	void write_indent();
-	void create_file();
-	void close_file();
 	void write_file();
 
+	static const CleanByteCounter get_clean_byte_count;
+
 	const Bytecode& bytecode;
-	const Ast& ast;
-	const bool forceOverwrite;
+	Ast& ast;
 	const bool minimizeDiffs;
 	const bool unrestrictedAscii;
-	HANDLE file = INVALID_HANDLE_VALUE;
+	const uint32_t threadCount;
+	FileWriter* const writer;
 	std::string writeBuffer;
 	uint32_t indentLevel = 0;
 	uint64_t prototypeDataLeft = 0;
+	bool isWorker = false;
+	std::vector<FunctionDefinition> functionDefinitions;
+	std::atomic<uint32_t> nextFunctionDefinition = 0;
+	std::atomic<uint64_t> prototypeDataWritten = 0;
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
 };
@@ -0,0 +1,44 @@
+#include "../main.h"
+
+// Writes the shortest round-trip digits of a finite number laid out like printf %.Ng with N = max(digits, 15).
+char* Lua::format_number(char* const& buffer, const double& number) {
+	const std::to_chars_result result = std::to_chars(buffer, buffer + MAX_NUMBER_SIZE, number, std::chars_format::scientific);
+	char* const digits = buffer + (*buffer == '-');
+	const char* exponent = digits + 1;
+	uint8_t fractionDigits = 0;
+
+	if (*exponent == '.') {
+		fractionDigits = (const char*)std::memchr(digits + 2, 'e', result.ptr - digits - 2) - digits - 2;
+		exponent += fractionDigits + 1;
+	}
+
+	int32_t exponentValue = 0;
+
+	for (const char* character = exponent + 2; character != result.ptr; character++) {
+		exponentValue = exponentValue * 10 + *character - '0';
+	}
+
+	if (exponent[1] == '-') exponentValue = -exponentValue;
+	if (exponentValue < -4 || exponentValue >= (fractionDigits < 14 ? 15 : fractionDigits + 1)) return result.ptr;
+
+	if (exponentValue < 0) {
+		const uint8_t zeroCount = -exponentValue - 1;
+		const char digit = digits[0];
+		std::memmove(digits + 3 + zeroCount, digits + 2, fractionDigits);
+		digits[2 + zeroCount] = digit;
+		std::memset(digits + 2, '0', zeroCount);
+		digits[0] = '0';
+		digits[1] = '.';
+		return digits + 3 + zeroCount + fractionDigits;
+	}
+
+	if (fractionDigits <= exponentValue) {
+		std::memmove(digits + 1, digits + 2, fractionDigits);
+		std::memset(digits + 1 + fractionDigits, '0', exponentValue - fractionDigits);
+		return digits + 1 + exponentValue;
+	}
+
+	std::memmove(digits + 1, digits + 2, exponentValue);
+	digits[1 + exponentValue] = '.';
+	return digits + 2 + fractionDigits;
+}
@@ -1,16 +1,13 @@
 #include "main.h"
 
-struct Error {
-	const std::string message;
-	const std::string filePath;
-	const std::string function;
-	const std::string source;
-	const std::string line;
-};
-
-static const HANDLE CONSOLE_OUTPUT = GetStdHandle(STD_OUTPUT_HANDLE);
 //static const HANDLE CONSOLE_INPUT = GetStdHandle(STD_INPUT_HANDLE);
+static constexpr uint32_t WRITER_THREADS = 2;
+static constexpr char STANDARD_STREAM_PATH[] = "-";
+static constexpr char STANDARD_INPUT_NAME[] = "stdin";
+
 static bool isCommandLine;
+static bool isArchiveInput = false;
+static bool isPipeMode = false;
 static bool isProgressBarActive = false;
 static uint32_t filesSkipped = 0;
 
@@ -18,20 +15,27 @@ static struct {
 	bool showHelp = false;
 	bool silentAssertions = false;
 	bool forceOverwrite = false;
+	bool skipUnchanged = false;
 	bool ignoreDebugInfo = false;
 	bool minimizeDiffs = false;
 	bool unrestrictedAscii = false;
+	bool lowMemory = false;
+#ifndef DISABLE_STATS
+	bool showStats = false;
+	Stats::FORMAT statsFormat = Stats::FORMAT_TABLE;
+#endif
+#ifndef DISABLE_TRACE
+	std::string traceFilePath;
+#endif
+	uint32_t walkThreads = 1;
+	uint32_t functionThreads = 1;
+	uint32_t prefetchCount = 4;
 	std::string inputPath;
 	std::string outputPath;
+	std::string archivePath;
 	std::string extensionFilter;
 } arguments;
 
-struct Directory {
-	const std::string path;
-	std::vector<Directory> folders;
-	std::vector<std::string> files;
-};
-
 static std::string string_to_lowercase(const std::string& string) {
 	std::string lowercaseString = string;
 
@@ -43,82 +47,149 @@ static std::string string_to_lowercase(const std::string& string) {
 	return lowercaseString;
 }
 
-static void find_files_recursively(Directory& directory) {
-	WIN32_FIND_DATAA pathData;
-	HANDLE handle = FindFirstFileA((arguments.inputPath + directory.path + '*').c_str(), &pathData);
-	if (handle == INVALID_HANDLE_VALUE) return;
-
-	do {
-		if (pathData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-			if (!std::strcmp(pathData.cFileName, ".") || !std::strcmp(pathData.cFileName, "..")) continue;
-			directory.folders.emplace_back(Directory{ .path = directory.path + pathData.cFileName + "\\" });
-			find_files_recursively(directory.folders.back());
-			if (!directory.folders.back().files.size() && !directory.folders.back().folders.size()) directory.folders.pop_back();
-			continue;
-		}
+static uint32_t get_file_name_index(const std::string& path) {
+	const size_t index = path.find_last_of(PATH_SEPARATORS);
+	return index == std::string::npos ? 0 : index + 1;
+}
 
-		if (!arguments.extensionFilter.size() || arguments.extensionFilter == string_to_lowercase(PathFindExtensionA(pathData.cFileName))) directory.files.emplace_back(pathData.cFileName);
-	} while (FindNextFileA(handle, &pathData));
+static std::string get_extension(const std::string& fileName) {
+	const size_t index = fileName.rfind('.');
+	return index == std::string::npos ? "" : fileName.substr(index);
+}
 
-	FindClose(handle);
+static bool is_input_file(const std::string& fileName) {
+	return !arguments.extensionFilter.size() || arguments.extensionFilter == string_to_lowercase(get_extension(fileName));
 }
 
-static bool decompile_files_recursively(const Directory& directory) {
-	CreateDirectoryA((arguments.outputPath + directory.path).c_str(), NULL);
-	std::string outputFile;
+static void print_error(const std::string& message) {
+	if (!isPipeMode) return print(message);
+	write_error_console((message + '\n').data(), message.size() + 1);
+}
+
+static bool is_archive_file(const std::string& fileName) {
+	const std::string extension = string_to_lowercase(get_extension(fileName));
+	return extension == ".zip" || extension == ".tar" || extension == ".tgz" || extension == ".gz";
+}
+
+static void create_output_directory(const std::string& path) {
+	if (arguments.archivePath.size() || arguments.outputPath == STANDARD_STREAM_PATH) return;
+	create_directory(arguments.outputPath);
+
+	for (size_t i = path.find_first_of(PATH_SEPARATORS); i != std::string::npos; i = path.find_first_of(PATH_SEPARATORS, i + 1)) {
+		create_directory(arguments.outputPath + path.substr(0, i + 1));
+	}
+}
+
+struct DecompilerContext {
+	Bytecode::Buffers bytecode;
+	Ast::Buffers ast;
+};
 
-	for (uint32_t i = 0; i < directory.files.size(); i++) {
-		outputFile = directory.files[i];
-		PathRemoveExtensionA(outputFile.data());
-		outputFile = outputFile.c_str();
-		outputFile += ".lua";
+static bool decompile_file(const std::string& path, const std::string& fileName, const std::vector<uint8_t>* fileData, const std::string& fileError, FileWriter* const& writer, DecompilerContext* const& context) {
+	const std::string outputFile = fileName.substr(0, fileName.size() - get_extension(fileName).size()) + ".lua";
 
-		Bytecode bytecode(arguments.inputPath + directory.path + directory.files[i]);
-		Ast ast(bytecode, arguments.ignoreDebugInfo, arguments.minimizeDiffs);
-		Lua lua(bytecode, ast, arguments.outputPath + directory.path + outputFile, arguments.forceOverwrite, arguments.minimizeDiffs, arguments.unrestrictedAscii);
+	while (true) {
+		Bytecode bytecode(arguments.inputPath + path + fileName, fileData ? fileData->data() : nullptr, fileData ? fileData->size() : 0, arguments.lowMemory ? 1 : arguments.functionThreads, context ? &context->bytecode : nullptr);
+#ifdef DISABLE_STATS
+		Ast ast(bytecode, arguments.ignoreDebugInfo, arguments.minimizeDiffs, arguments.lowMemory, nullptr, context ? &context->ast : nullptr);
+#else
+		Stats stats(bytecode.filePath);
+		Ast ast(bytecode, arguments.ignoreDebugInfo, arguments.minimizeDiffs, arguments.lowMemory, arguments.showStats ? &stats : nullptr, context ? &context->ast : nullptr);
+#endif
+		Lua lua(bytecode, ast, arguments.outputPath + path + outputFile, arguments.minimizeDiffs, arguments.unrestrictedAscii, arguments.lowMemory ? 1 : arguments.functionThreads, writer);
+		TRACE_SCOPE_FILE("decompile_file", bytecode.filePath);
 
 		try {
 			print("--------------------\nInput file: " + bytecode.filePath + "\nReading bytecode...");
+			assert(!fileError.size(), fileError, bytecode.filePath, DEBUG_INFO);
 			bytecode();
 			print("Building ast...");
 			ast();
 			print("Writing lua source...");
+#ifndef _DEBUG
+			if (writer && !arguments.forceOverwrite && !arguments.skipUnchanged && (writer->is_claimed(lua.filePath) || (!arguments.archivePath.size() && get_path_type(lua.filePath) != PATH_INVALID))) assert(!isPipeMode && show_overwrite_dialog(lua.filePath), "File already exists", lua.filePath, DEBUG_INFO);
+#endif
 			lua();
-			print("Output file: " + lua.filePath);
+
+			if (!writer) {
+				assert(write_standard_output(lua.source.data(), lua.source.size()), "Failed writing to standard output", lua.filePath, DEBUG_INFO);
+				return true;
+			}
+
+			print((writer->is_asynchronous() ? "Output file queued: " : "Output file: ") + lua.filePath);
+#ifndef DISABLE_STATS
+			if (arguments.showStats) print(stats.to_string(arguments.statsFormat));
+#endif
+			return true;
 		} catch (const Error& error) {
 			erase_progress_bar();
 
-			if (arguments.silentAssertions) {
-				print("\nError running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\n" + error.message);
+			switch (arguments.silentAssertions ? DIALOG_UNAVAILABLE : show_error_dialog("Error running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\nFile: " + error.filePath + "\n\n" + error.message)) {
+			case DIALOG_UNAVAILABLE:
+				print_error("\nError running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\n" + error.message);
 				filesSkipped++;
-				continue;
-			}
-
-			switch (MessageBoxA(NULL, ("Error running " + error.function + "\nSource: " + error.source + ":" + error.line + "\n\nFile: " + error.filePath + "\n\n" + error.message).c_str(),
-				PROGRAM_NAME, MB_ICONERROR | MB_CANCELTRYCONTINUE | MB_DEFBUTTON3)) {
-			case IDCANCEL:
+				return true;
+			case DIALOG_CANCEL:
 				return false;
-			case IDTRYAGAIN:
+			case DIALOG_RETRY:
 				print("Retrying...");
-				i--;
+				if (!isArchiveInput) fileData = nullptr;
 				continue;
-			case IDCONTINUE:
+			case DIALOG_CONTINUE:
 				print("File skipped.");
 				filesSkipped++;
+				return true;
 			}
 		} catch (...) {
-			MessageBoxA(NULL, std::string("Unknown exception\n\nFile: " + bytecode.filePath).c_str(), PROGRAM_NAME, MB_ICONERROR | MB_OK);
+			show_fatal_error_dialog("Unknown exception\n\nFile: " + bytecode.filePath);
 			throw;
 		}
 	}
+}
+
+static bool decompile_files(FileReader& reader, FileWriter& writer, uint32_t& filesFound) {
+	FileReader::File file;
+	std::string outputPath;
+	DecompilerContext context;
+
+	while (reader.next_file(file)) {
+		filesFound++;
 
-	for (uint32_t i = 0; i < directory.folders.size(); i++) {
-		if (!decompile_files_recursively(directory.folders[i])) return false;
+		if (file.path != outputPath) {
+			outputPath = file.path;
+			create_output_directory(outputPath);
+		}
+
+		if (!decompile_file(file.path, file.name, file.isLoaded ? &file.data : nullptr, file.error, &writer, arguments.lowMemory ? nullptr : &context)) {
+			reader.stop();
+			return false;
+		}
 	}
 
 	return true;
 }
 
+#ifndef DISABLE_STATS
+static bool parse_stats_format(const std::string& format) {
+	if (format == "table") {
+		arguments.statsFormat = Stats::FORMAT_TABLE;
+		return true;
+	}
+
+	if (format == "json") {
+		arguments.statsFormat = Stats::FORMAT_JSON;
+		return true;
+	}
+
+	return false;
+}
+#endif
+
+static bool parse_count(const std::string& string, uint32_t& count) {
+	const std::from_chars_result result = std::from_chars(string.data(), string.data() + string.size(), count);
+	return result.ec == std::errc() && result.ptr == string.data() + string.size() && count;
+}
+
 static char* parse_arguments(const int& argc, char** const& argv) {
 	if (argc < 2) return nullptr;
 	arguments.inputPath = argv[1];
@@ -127,7 +198,7 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 #endif
 	bool isInputPathSet = true;
 
-	if (arguments.inputPath.size() && arguments.inputPath.front() == '-') {
+	if (arguments.inputPath.size() && arguments.inputPath.front() == '-' && arguments.inputPath != STANDARD_STREAM_PATH) {
 		arguments.inputPath.clear();
 		isInputPathSet = false;
 	}
@@ -141,7 +212,13 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 			if (argument[1] == '-') {
 				argument = argument.c_str() + 2;
 
-				if (argument == "extension") {
+				if (argument == "archive") {
+					if (i <= argc - 2) {
+						i++;
+						arguments.archivePath = argv[i];
+						continue;
+					}
+				} else if (argument == "extension") {
 					if (i <= argc - 2) {
 						i++;
 						arguments.extensionFilter = argv[i];
@@ -150,12 +227,20 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 				} else if (argument == "force_overwrite") {
 					arguments.forceOverwrite = true;
 					continue;
+				} else if (argument == "function_threads") {
+					if (i <= argc - 2 && parse_count(argv[i + 1], arguments.functionThreads)) {
+						i++;
+						continue;
+					}
 				} else if (argument == "help") {
 					arguments.showHelp = true;
 					continue;
 				} else if (argument == "ignore_debug_info") {
 					arguments.ignoreDebugInfo = true;
 					continue;
+				} else if (argument == "low_memory") {
+					arguments.lowMemory = true;
+					continue;
 				} else if (argument == "minimize_diffs") {
 					arguments.minimizeDiffs = true;
 					continue;
@@ -165,15 +250,47 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 						arguments.outputPath = argv[i];
 						continue;
 					}
+				} else if (argument == "prefetch") {
+					if (i <= argc - 2 && parse_count(argv[i + 1], arguments.prefetchCount)) {
+						i++;
+						continue;
+					}
+				} else if (argument == "skip_unchanged") {
+					arguments.skipUnchanged = true;
+					continue;
 				} else if (argument == "silent_assertions") {
 					arguments.silentAssertions = true;
 					continue;
+#ifndef DISABLE_STATS
+				} else if (argument == "stats") {
+					arguments.showStats = true;
+					if (i <= argc - 2 && parse_stats_format(argv[i + 1])) i++;
+					continue;
+#endif
+#ifndef DISABLE_TRACE
+				} else if (argument == "trace") {
+					if (i <= argc - 2) {
+						i++;
+						arguments.traceFilePath = argv[i];
+						continue;
+					}
+#endif
 				} else if (argument == "unrestricted_ascii") {
 					arguments.unrestrictedAscii = true;
 					continue;
+				} else if (argument == "walk_threads") {
+					if (i <= argc - 2 && parse_count(argv[i + 1], arguments.walkThreads)) {
+						i++;
+						continue;
+					}
 				}
 			} else if (argument.size() == 2) {
 				switch (argument[1]) {
+				case 'a':
+					if (i > argc - 2) break;
+					i++;
+					arguments.archivePath = argv[i];
+					continue;
 				case 'e':
 					if (i > argc - 2) break;
 					i++;
@@ -189,6 +306,16 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 				case 'i':
 					arguments.ignoreDebugInfo = true;
 					continue;
+				case 'j':
+					if (i > argc - 2 || !parse_count(argv[i + 1], arguments.functionThreads)) break;
+					i++;
+					continue;
+				case 'k':
+					arguments.skipUnchanged = true;
+					continue;
+				case 'l':
+					arguments.lowMemory = true;
+					continue;
 				case 'm':
 					arguments.minimizeDiffs = true;
 					continue;
@@ -197,12 +324,26 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 					i++;
 					arguments.outputPath = argv[i];
 					continue;
+				case 'p':
+					if (i > argc - 2 || !parse_count(argv[i + 1], arguments.prefetchCount)) break;
+					i++;
+					continue;
 				case 's':
 					arguments.silentAssertions = true;
 					continue;
+#ifndef DISABLE_STATS
+				case 't':
+					arguments.showStats = true;
+					if (i <= argc - 2 && parse_stats_format(argv[i + 1])) i++;
+					continue;
+#endif
 				case 'u':
 					arguments.unrestrictedAscii = true;
 					continue;
+				case 'w':
+					if (i > argc - 2 || !parse_count(argv[i + 1], arguments.walkThreads)) break;
+					i++;
+					continue;
 				}
 			}
 		}
@@ -216,48 +357,57 @@ static char* parse_arguments(const int& argc, char** const& argv) {
 static void wait_for_exit() {
 	if (isCommandLine) return;
 	print("Press any key to exit.");
-
-	while (!_kbhit()) {
-		Sleep(0);
-	};
+	wait_for_key();
 }
 
-int main(int argc, char* argv[]) {
-	SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
-
-	{
-		HWND window = GetConsoleWindow();
-		DWORD consoleProcessId;
-		GetWindowThreadProcessId(window, &consoleProcessId);
-#ifdef _DEBUG
-		isCommandLine = false;
-#else
-		isCommandLine = consoleProcessId != GetCurrentProcessId();
-		if (!isCommandLine) SetWindowTextA(window, PROGRAM_NAME);
-#endif
+static int run(int argc, char* argv[]) {
+	isCommandLine = initialize_console();
+	const char* const invalidArgument = parse_arguments(argc, argv);
+	isPipeMode = arguments.inputPath == STANDARD_STREAM_PATH || arguments.outputPath == STANDARD_STREAM_PATH;
+
+	if (isPipeMode) {
+		isCommandLine = true;
+		arguments.silentAssertions = true;
 	}
 
 	print(std::string(PROGRAM_NAME) + "\nCompiled on " + __DATE__);
 	
-	if (parse_arguments(argc, argv)) {
-		print("Invalid argument: " + std::string(parse_arguments(argc, argv)) + "\nUse -? to show usage and options.");
+	if (invalidArgument) {
+		print_error("Invalid argument: " + std::string(invalidArgument) + "\nUse -? to show usage and options.");
 		return EXIT_FAILURE;
 	}
 	
 	if (arguments.showHelp) {
 		print(
-			"Usage: luajit-decompiler-v2.exe INPUT_PATH [options]\n"
+			"Usage: luajit-decompiler-v2 INPUT_PATH [options]\n"
+			"Use - as INPUT_PATH to read bytecode from standard input.\n"
 			"\n"
 			"Available options:\n"
 			"  -h, -?, --help\t\tShow this message\n"
-			"  -o, --output OUTPUT_PATH\tOverride default output directory\n"
+			"  -o, --output OUTPUT_PATH\tOverride default output directory,\n"
+			"\t\t\t\t  or - to write to standard output\n"
+			"  -a, --archive OUTPUT_FILE\tWrite all output files into a single tar archive,\n"
+			"\t\t\t\t  gzip compressed if OUTPUT_FILE ends with .gz or .tgz\n"
 			"  -e, --extension EXTENSION\tOnly decompile files with the specified extension\n"
 			"  -s, --silent_assertions\tDisable assertion error pop-up window\n"
 			"\t\t\t\t  and auto skip files that fail to decompile\n"
 			"  -f, --force_overwrite\t\tAlways overwrite existing files\n"
+			"  -k, --skip_unchanged\t\tOverwrite existing files only if their contents changed\n"
 			"  -i, --ignore_debug_info\tIgnore bytecode debug info\n"
 			"  -m, --minimize_diffs\t\tOptimize output formatting to help minimize diffs\n"
-			"  -u, --unrestricted_ascii\tDisable default UTF-8 encoding and string restrictions"
+			"  -u, --unrestricted_ascii\tDisable default UTF-8 encoding and string restrictions\n"
+			"  -l, --low_memory\t\tBuild and free each function while writing the output\n"
+			"\t\t\t\t  to reduce memory usage on large files\n"
+			"  -w, --walk_threads COUNT\tWalk input subdirectories on COUNT threads\n"
+			"  -j, --function_threads COUNT\tRead the prototypes and write the functions\n"
+			"\t\t\t\t  of each file on COUNT threads, ignored with --low_memory\n"
+			"  -p, --prefetch COUNT\t\tRead up to COUNT input files ahead of the decompiler"
+#ifndef DISABLE_STATS
+			"\n  -t, --stats [table|json]\tPrint per pass and per function ast statistics"
+#endif
+#ifndef DISABLE_TRACE
+			"\n  --trace OUTPUT_FILE\t\tWrite a Chrome trace event timeline of the run"
+#endif
 		);
 		return EXIT_SUCCESS;
 	}
@@ -265,45 +415,29 @@ int main(int argc, char* argv[]) {
 	if (!arguments.inputPath.size()) {
 		print("No input path specified!");
 		if (isCommandLine) return EXIT_FAILURE;
-		arguments.inputPath.resize(MAX_PATH, NULL);
-		OPENFILENAMEA dialogInfo = {
-			.lStructSize = sizeof(OPENFILENAMEA),
-			.hwndOwner = NULL,
-			.lpstrFilter = NULL,
-			.lpstrCustomFilter = NULL,
-			.lpstrFile = arguments.inputPath.data(),
-			.nMaxFile = (DWORD)arguments.inputPath.size(),
-			.lpstrFileTitle = NULL,
-			.lpstrInitialDir = NULL,
-			.lpstrTitle = PROGRAM_NAME,
-			.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST,
-			.lpstrDefExt = NULL,
-			.FlagsEx = NULL
-		};
 		print("Please select a valid LuaJIT bytecode file.");
-		if (!GetOpenFileNameA(&dialogInfo)) return EXIT_FAILURE;
-		arguments.inputPath = arguments.inputPath.c_str();
+		if (!show_open_file_dialog(arguments.inputPath)) return EXIT_FAILURE;
 	}
 
-	DWORD pathAttributes;
+	PATH_TYPE pathType;
 
-	if (!arguments.outputPath.size()) {
-		arguments.outputPath.resize(MAX_PATH);
-		GetModuleFileNameA(NULL, arguments.outputPath.data(), arguments.outputPath.size());
-		*PathFindFileNameA(arguments.outputPath.data()) = '\x00';
-		arguments.outputPath = arguments.outputPath.c_str();
-		arguments.outputPath += "output\\";
-		arguments.outputPath.shrink_to_fit();
-	} else {
-		pathAttributes = GetFileAttributesA(arguments.outputPath.c_str());
+	if (arguments.archivePath.size()) {
+		if (arguments.outputPath.size()) {
+			print_error("Output path and archive can not be combined!");
+			return EXIT_FAILURE;
+		}
+	} else if (!arguments.outputPath.size()) {
+		arguments.outputPath = get_executable_directory() + "output" + PATH_SEPARATOR;
+	} else if (arguments.outputPath != STANDARD_STREAM_PATH) {
+		pathType = get_path_type(arguments.outputPath);
 
-		if (pathAttributes == INVALID_FILE_ATTRIBUTES) {
-			print("Failed to open output path: " + arguments.outputPath);
+		if (pathType == PATH_INVALID) {
+			print_error("Failed to open output path: " + arguments.outputPath);
 			return EXIT_FAILURE;
 		}
 
-		if (!(pathAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-			print("Output path is not a folder!");
+		if (pathType != PATH_DIRECTORY) {
+			print_error("Output path is not a folder!");
 			return EXIT_FAILURE;
 		}
 
@@ -312,7 +446,7 @@ int main(int argc, char* argv[]) {
 		case '\\':
 			break;
 		default:
-			arguments.outputPath += '\\';
+			arguments.outputPath += PATH_SEPARATOR;
 			break;
 		}
 	}
@@ -322,58 +456,159 @@ int main(int argc, char* argv[]) {
 		arguments.extensionFilter = string_to_lowercase(arguments.extensionFilter);
 	}
 
-	pathAttributes = GetFileAttributesA(arguments.inputPath.c_str());
+	std::vector<uint8_t> standardInput;
+	const bool isStandardInput = arguments.inputPath == STANDARD_STREAM_PATH;
 
-	if (pathAttributes == INVALID_FILE_ATTRIBUTES) {
-		print("Failed to open input path: " + arguments.inputPath);
-		wait_for_exit();
+	if (isStandardInput) {
+		pathType = PATH_FILE;
+
+		if (!read_standard_input(standardInput)) {
+			print_error("Failed reading standard input");
+			return EXIT_FAILURE;
+		}
+	} else {
+		pathType = get_path_type(arguments.inputPath);
+
+		if (pathType == PATH_INVALID) {
+			print_error("Failed to open input path: " + arguments.inputPath);
+			wait_for_exit();
+			return EXIT_FAILURE;
+		}
+	}
+
+	isArchiveInput = !isStandardInput && pathType == PATH_FILE && is_archive_file(arguments.inputPath);
+
+	if (arguments.outputPath == STANDARD_STREAM_PATH && (pathType == PATH_DIRECTORY || isArchiveInput)) {
+		print_error("Standard output requires a single input file!");
 		return EXIT_FAILURE;
 	}
 
-	Directory root;
+	ArchiveReader archiveReader(arguments.inputPath, is_input_file);
 
-	if (pathAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+	if (isArchiveInput && !archiveReader.open()) {
+		print_error("Failed to open archive: " + arguments.inputPath);
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
+	if (pathType == PATH_DIRECTORY || isArchiveInput) {
 		switch (arguments.inputPath.back()) {
 		case '/':
 		case '\\':
 			break;
 		default:
-			arguments.inputPath += '\\';
+			arguments.inputPath += PATH_SEPARATOR;
 			break;
 		}
+	}
 
-		find_files_recursively(root);
+	const std::string archiveExtension = string_to_lowercase(get_extension(arguments.archivePath));
+	ArchiveWriter archive(arguments.archivePath, archiveExtension == ".gz" || archiveExtension == ".tgz");
 
-		if (!root.files.size() && !root.folders.size()) {
-			print("No files " + (arguments.extensionFilter.size() ? "with extension " + arguments.extensionFilter + " " : "") + "found in path: " + arguments.inputPath);
+	if (arguments.archivePath.size()) {
+#ifndef _DEBUG
+		if (!arguments.forceOverwrite && get_path_type(archive.filePath) != PATH_INVALID && !show_overwrite_dialog(archive.filePath)) {
+			print_error("File already exists: " + archive.filePath);
 			wait_for_exit();
 			return EXIT_FAILURE;
 		}
-	} else {
-		root.files.emplace_back(PathFindFileNameA(arguments.inputPath.c_str()));
-		*PathFindFileNameA(arguments.inputPath.c_str()) = '\x00';
-		arguments.inputPath = arguments.inputPath.c_str();
-	}
+#endif
 
-	try {
-		if (!decompile_files_recursively(root)) {
-			print("--------------------\nAborted!");
+		if (!archive.open()) {
+			print_error("Failed to create archive: " + archive.filePath);
 			wait_for_exit();
 			return EXIT_FAILURE;
 		}
+	}
+
+#ifndef DISABLE_TRACE
+	if (arguments.traceFilePath.size()) Trace::begin();
+#endif
+	std::vector<std::string> failedOutputFiles;
+	uint32_t filesFound = 0;
+	uint32_t filesUnchanged = 0;
+	bool isAborted;
+
+	try {
+		if (pathType == PATH_DIRECTORY) {
+			DirectoryWalker walker(arguments.inputPath, is_input_file, arguments.walkThreads);
+			FileReader reader(walker, arguments.inputPath, arguments.prefetchCount);
+			FileWriter writer(WRITER_THREADS, arguments.skipUnchanged, arguments.archivePath.size() ? &archive : nullptr);
+			walker();
+			reader();
+			writer();
+			isAborted = !decompile_files(reader, writer, filesFound);
+			failedOutputFiles = writer.finish();
+			filesUnchanged = writer.unchangedFiles;
+		} else if (isArchiveInput) {
+			FileReader reader(archiveReader, arguments.prefetchCount);
+			FileWriter writer(WRITER_THREADS, arguments.skipUnchanged, arguments.archivePath.size() ? &archive : nullptr);
+			reader();
+			writer();
+			isAborted = !decompile_files(reader, writer, filesFound);
+			failedOutputFiles = writer.finish();
+			filesUnchanged = writer.unchangedFiles;
+		} else {
+			const std::string fileName = isStandardInput ? STANDARD_INPUT_NAME : arguments.inputPath.substr(get_file_name_index(arguments.inputPath));
+			arguments.inputPath.resize(isStandardInput ? 0 : get_file_name_index(arguments.inputPath));
+			create_output_directory("");
+			FileWriter writer(0, arguments.skipUnchanged, arguments.archivePath.size() ? &archive : nullptr);
+			filesFound++;
+			isAborted = !decompile_file("", fileName, isStandardInput ? &standardInput : nullptr, "", arguments.outputPath == STANDARD_STREAM_PATH ? nullptr : &writer, nullptr);
+			filesUnchanged = writer.unchangedFiles;
+		}
 	} catch (...) {
 		throw;
 	}
 
+	for (uint32_t i = 0; i < failedOutputFiles.size(); i++) {
+		print("--------------------\nFailed writing to file: " + failedOutputFiles[i]);
+		filesSkipped++;
+	}
+
+	if (arguments.archivePath.size() && !archive.close()) {
+		print_error("--------------------\nFailed writing to archive: " + archive.filePath);
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
+	if (archiveReader.isFailed) {
+		print_error("--------------------\nFailed reading archive: " + archiveReader.filePath);
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
+#ifndef DISABLE_TRACE
+	if (arguments.traceFilePath.size() && !Trace::write_file(arguments.traceFilePath)) print("--------------------\nFailed to write trace file: " + arguments.traceFilePath);
+#endif
+	if (isPipeMode) return isAborted || filesSkipped ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (!filesFound) {
+		print("No files " + (arguments.extensionFilter.size() ? "with extension " + arguments.extensionFilter + " " : "") + "found in path: " + arguments.inputPath);
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
+	if (isAborted) {
+		print("--------------------\nAborted!");
+		wait_for_exit();
+		return EXIT_FAILURE;
+	}
+
 #ifndef _DEBUG
-	print("--------------------\n" + (filesSkipped ? "Failed to decompile " + std::to_string(filesSkipped) + " file" + (filesSkipped > 1 ? "s" : "") + ".\n" : "") + "Done!");
+	print("--------------------\n" + (filesUnchanged ? std::to_string(filesUnchanged) + " unchanged file" + (filesUnchanged > 1 ? "s" : "") + " not rewritten.\n" : "") + (filesSkipped ? "Failed to decompile " + std::to_string(filesSkipped) + " file" + (filesSkipped > 1 ? "s" : "") + ".\n" : "") + "Done!");
 	wait_for_exit();
 #endif
 	return EXIT_SUCCESS;
 }
 
+int main(int argc, char* argv[]) {
+	return run_main_thread(run, argc, argv);
+}
+
 void print(const std::string& message) {
-	WriteConsoleA(CONSOLE_OUTPUT, (message + '\n').data(), message.size() + 1, NULL, NULL);
+	if (isPipeMode) return;
+	write_console((message + '\n').data(), message.size() + 1);
 }
 
 /*
@@ -389,13 +624,15 @@ std::string input() {
 void print_progress_bar(const double& progress, const double& total) {
 	static char PROGRESS_BAR[] = "\r[====================]";
 
+	if (isPipeMode) return;
+
 	const uint8_t threshold = std::round(20 / total * progress);
 
 	for (uint8_t i = 20; i--;) {
 		PROGRESS_BAR[i + 2] = i < threshold ? '=' : ' ';
 	}
 
-	WriteConsoleA(CONSOLE_OUTPUT, PROGRESS_BAR, sizeof(PROGRESS_BAR) - 1, NULL, NULL);
+	write_console(PROGRESS_BAR, sizeof(PROGRESS_BAR) - 1);
 	isProgressBarActive = true;
 }
 
@@ -403,28 +640,6 @@ void erase_progress_bar() {
 	static constexpr char PROGRESS_BAR_ERASER[] = "\r                      \r";
 
 	if (!isProgressBarActive) return;
-	WriteConsoleA(CONSOLE_OUTPUT, PROGRESS_BAR_ERASER, sizeof(PROGRESS_BAR_ERASER) - 1, NULL, NULL);
+	write_console(PROGRESS_BAR_ERASER, sizeof(PROGRESS_BAR_ERASER) - 1);
 	isProgressBarActive = false;
 }
-
-void assert(const bool& assertion, const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line) {
-	if (!assertion) throw Error{
-		.message = message,
-		.filePath = filePath,
-		.function = function,
-		.source = source,
-		.line = std::to_string(line)
-	};
-}
-
-std::string byte_to_string(const uint8_t& byte) {
-	char string[] = "0x00";
-	uint8_t digit;
-	
-	for (uint8_t i = 2; i--;) {
-		digit = (byte >> i * 4) & 0xF;
-		string[3 - i] = digit >= 0xA ? 'A' + digit - 0xA : '0' + digit;
-	}
-
-	return string;
-}
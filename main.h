@@ -1,30 +1,64 @@
 /*
 Requirements:
-  Visual Studio
+  Visual Studio or GCC/Clang
   C++20
-  Windows API
-  Default char is unsigned (/J)
+  Windows API or POSIX
+  Default char is unsigned (/J or -funsigned-char)
 */
 
-#ifndef _CHAR_UNSIGNED
+#if !defined _CHAR_UNSIGNED && !defined __CHAR_UNSIGNED__
 #error Default char is not unsigned!
 #endif
 
+#ifdef _MSC_VER
 #pragma comment(linker, "/stack:268435456")
 #pragma comment(linker, "/manifestdependency:\"type='win32' name='Microsoft.Windows.Common-Controls' version='6.0.0.0' processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #pragma comment(lib, "shlwapi.lib")
+#endif
 
+#include <algorithm>
+#include <atomic>
 #include <bit>
+#include <charconv>
+#include <chrono>
+#include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <exception>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#ifdef _WIN32
+#include <intrin.h>
 #include <windows.h>
 #include <conio.h>
 #include <fileapi.h>
 #include <shlwapi.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined __x86_64__ || defined __i386__
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#endif
 
 #define DEBUG_INFO __FUNCTION__, __FILE__, __LINE__
 
@@ -35,6 +69,14 @@ constexpr uint64_t DOUBLE_FRACTION = 0x000FFFFFFFFFFFFF;
 constexpr uint64_t DOUBLE_SPECIAL = DOUBLE_EXPONENT;
 constexpr uint64_t DOUBLE_NEGATIVE_ZERO = DOUBLE_SIGN;
 
+struct Error {
+	const std::string message;
+	const std::string filePath;
+	const std::string function;
+	const std::string source;
+	const std::string line;
+};
+
 void print(const std::string& message);
 //std::string input();
 void print_progress_bar(const double& progress = 0, const double& total = 100);
@@ -42,10 +84,24 @@ void erase_progress_bar();
 void assert(const bool& assertion, const std::string& message, const std::string& filePath, const std::string& function, const std::string& source, const uint32_t& line);
 std::string byte_to_string(const uint8_t& byte);
 
+class Stats;
+class Trace;
+class DirectoryWalker;
+class FileReader;
+class FileWriter;
 class Bytecode;
 class Ast;
 class Lua;
 
-#include "bytecode\bytecode.h"
-#include "ast\ast.h"
-#include "lua\lua.h"
+#include "library/library.h"
+#include "platform/platform.h"
+#include "queue/queue.h"
+#include "stats/stats.h"
+#include "trace/trace.h"
+#include "walker/walker.h"
+#include "compression/compression.h"
+#include "archive/archive.h"
+#include "pipeline/pipeline.h"
+#include "bytecode/bytecode.h"
+#include "ast/ast.h"
+#include "lua/lua.h"
@@ -0,0 +1,163 @@
+#include "../main.h"
+
+FileReader::FileReader(DirectoryWalker& walker, const std::string& rootPath, const uint32_t& prefetchCount)
+	: walker(&walker), archive(nullptr), rootPath(rootPath), files(prefetchCount ? prefetchCount : 1) {}
+
+FileReader::FileReader(ArchiveReader& archive, const uint32_t& prefetchCount)
+	: walker(nullptr), archive(&archive), files(prefetchCount ? prefetchCount : 1) {}
+
+FileReader::~FileReader() {
+	stop();
+	if (thread.joinable()) thread.join();
+}
+
+void FileReader::operator()() {
+	thread = std::thread(archive ? &FileReader::read_archive : &FileReader::read, this);
+}
+
+bool FileReader::next_file(File& file) {
+	return files.pop(file);
+}
+
+void FileReader::stop() {
+	if (walker) walker->stop();
+	files.close();
+}
+
+void FileReader::read() {
+	DirectoryWalker::File walkerFile;
+	InputFile inputFile;
+
+	while (walker->next_file(walkerFile)) {
+		File file = { .path = std::move(walkerFile.path), .name = std::move(walkerFile.name) };
+
+		{
+			TRACE_SCOPE_FILE("FileReader::read", file.name);
+
+			if (inputFile.open(rootPath + file.path + file.name) && inputFile.size <= UINT32_MAX) {
+				file.data.resize(inputFile.size);
+				file.isLoaded = inputFile.read(file.data.data(), file.data.size());
+				if (!file.isLoaded) file.data.clear();
+			}
+
+			inputFile.close();
+		}
+
+		if (!files.push(std::move(file))) break;
+	}
+
+	files.close();
+}
+
+void FileReader::read_archive() {
+	ArchiveReader::File archiveFile;
+
+	while (true) {
+		{
+			TRACE_SCOPE_FILE("FileReader::read_archive", archive->filePath);
+			if (!archive->next_file(archiveFile)) break;
+		}
+
+		File file = { .path = std::move(archiveFile.path), .name = std::move(archiveFile.name), .data = std::move(archiveFile.data), .isLoaded = !archiveFile.error.size(), .error = std::move(archiveFile.error) };
+		if (!files.push(std::move(file))) break;
+	}
+
+	files.close();
+}
+
+FileWriter::FileWriter(const uint32_t& threadCount, const bool& skipUnchanged, ArchiveWriter* const& archive)
+	: threadCount(archive && threadCount ? 1 : threadCount), skipUnchanged(skipUnchanged), archive(archive), outputs(OUTPUT_QUEUE_SIZE) {}
+
+FileWriter::~FileWriter() {
+	finish();
+}
+
+void FileWriter::operator()() {
+	for (uint32_t i = 0; i < threadCount; i++) {
+		threads.emplace_back(&FileWriter::run, this);
+	}
+}
+
+bool FileWriter::is_claimed(const std::string& filePath) const {
+	return claimedFiles.contains(filePath);
+}
+
+bool FileWriter::is_asynchronous() const {
+	return threadCount;
+}
+
+bool FileWriter::write(const std::string& filePath, std::string&& data) {
+	claimedFiles.emplace(filePath);
+	if (!threadCount) return write_file(filePath, data);
+
+	{
+		std::unique_lock<std::mutex> lock(pendingFilesMutex);
+		pendingFileWritten.wait(lock, [this, &filePath] { return !pendingFiles.contains(filePath); });
+		pendingFiles.emplace(filePath);
+	}
+
+	outputs.push(Output{ .filePath = filePath, .data = std::move(data) });
+	return true;
+}
+
+std::vector<std::string> FileWriter::finish() {
+	outputs.close();
+
+	for (uint32_t i = threads.size(); i--;) {
+		threads[i].join();
+	}
+
+	threads.clear();
+	const std::lock_guard<std::mutex> lock(failedFilesMutex);
+	return std::move(failedFiles);
+}
+
+void FileWriter::run() {
+	Output output;
+
+	while (outputs.pop(output)) {
+		if (!write_file(output.filePath, output.data)) {
+			const std::lock_guard<std::mutex> lock(failedFilesMutex);
+			failedFiles.emplace_back(output.filePath);
+		}
+
+		{
+			const std::lock_guard<std::mutex> lock(pendingFilesMutex);
+			pendingFiles.erase(output.filePath);
+		}
+
+		pendingFileWritten.notify_all();
+	}
+}
+
+bool FileWriter::write_file(const std::string& filePath, const std::string& data) {
+	TRACE_SCOPE_FILE("FileWriter::write_file", filePath);
+	if (archive) return archive->add_file(filePath, data);
+	OutputFile outputFile;
+	if (!skipUnchanged) return outputFile.create(filePath) && outputFile.write(data.data(), data.size());
+
+	if (is_file_unchanged(filePath, data)) {
+		unchangedFiles++;
+		return true;
+	}
+
+	const std::string temporaryFilePath = filePath + "." + std::to_string(get_process_id()) + "." + std::to_string(temporaryFileCount++) + TEMPORARY_EXTENSION;
+
+	if (!outputFile.create(temporaryFilePath) || !outputFile.write(data.data(), data.size()) || !outputFile.flush()) {
+		outputFile.close();
+		delete_file(temporaryFilePath);
+		return false;
+	}
+
+	outputFile.close();
+	if (rename_file(temporaryFilePath, filePath)) return true;
+	delete_file(temporaryFilePath);
+	return false;
+}
+
+bool FileWriter::is_file_unchanged(const std::string& filePath, const std::string& data) {
+	InputFile inputFile;
+	if (!inputFile.open(filePath) || inputFile.size != data.size()) return false;
+	std::vector<uint8_t> fileData(data.size());
+	return inputFile.read(fileData.data(), fileData.size()) && !std::memcmp(fileData.data(), data.data(), data.size());
+}
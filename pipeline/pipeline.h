@@ -0,0 +1,73 @@
+class FileReader {
+public:
+
+	struct File {
+		std::string path;
+		std::string name;
+		std::vector<uint8_t> data;
+		bool isLoaded = false;
+		std::string error;
+	};
+
+	FileReader(DirectoryWalker& walker, const std::string& rootPath, const uint32_t& prefetchCount);
+	FileReader(ArchiveReader& archive, const uint32_t& prefetchCount);
+	~FileReader();
+
+	void operator()();
+	bool next_file(File& file);
+	void stop();
+
+private:
+
+	void read();
+	void read_archive();
+
+	DirectoryWalker* const walker;
+	ArchiveReader* const archive;
+	const std::string rootPath;
+	BoundedQueue<File> files;
+	std::thread thread;
+};
+
+class FileWriter {
+public:
+
+	FileWriter(const uint32_t& threadCount, const bool& skipUnchanged, ArchiveWriter* const& archive);
+	~FileWriter();
+
+	void operator()();
+	bool is_claimed(const std::string& filePath) const;
+	bool is_asynchronous() const;
+	bool write(const std::string& filePath, std::string&& data);
+	std::vector<std::string> finish();
+
+	std::atomic<uint32_t> unchangedFiles = 0;
+
+private:
+
+	static constexpr uint32_t OUTPUT_QUEUE_SIZE = 16;
+	static constexpr char TEMPORARY_EXTENSION[] = ".tmp";
+
+	struct Output {
+		std::string filePath;
+		std::string data;
+	};
+
+	void run();
+	bool write_file(const std::string& filePath, const std::string& data);
+	static bool is_file_unchanged(const std::string& filePath, const std::string& data);
+
+	static inline std::atomic<uint32_t> temporaryFileCount = 0;
+
+	const uint32_t threadCount;
+	const bool skipUnchanged;
+	ArchiveWriter* const archive;
+	BoundedQueue<Output> outputs;
+	std::vector<std::thread> threads;
+	std::unordered_set<std::string> claimedFiles;
+	std::unordered_set<std::string> pendingFiles;
+	std::mutex pendingFilesMutex;
+	std::condition_variable pendingFileWritten;
+	std::mutex failedFilesMutex;
+	std::vector<std::string> failedFiles;
+};
@@ -0,0 +1,122 @@
+#if defined _M_X64 || defined _M_IX86 || defined __x86_64__ || defined __i386__
+#define PLATFORM_X86
+#endif
+
+#ifdef _MSC_VER
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#ifdef _WIN32
+constexpr char PATH_SEPARATOR = '\\';
+constexpr char PATH_SEPARATORS[] = "\\/";
+#else
+constexpr char PATH_SEPARATOR = '/';
+constexpr char PATH_SEPARATORS[] = "/";
+#endif
+
+enum PATH_TYPE {
+	PATH_INVALID,
+	PATH_FILE,
+	PATH_DIRECTORY
+};
+
+enum DIALOG_RESULT {
+	DIALOG_UNAVAILABLE,
+	DIALOG_CANCEL,
+	DIALOG_RETRY,
+	DIALOG_CONTINUE
+};
+
+struct DirectoryEntry {
+	std::string name;
+	bool isDirectory = false;
+};
+
+class InputFile {
+public:
+
+	~InputFile();
+
+	bool open(const std::string& filePath);
+	void close();
+	bool read(uint8_t* const& buffer, const uint32_t& byteCount);
+
+	uint64_t size = 0;
+
+private:
+
+#ifdef _WIN32
+	HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+	int descriptor = -1;
+	uint8_t* mapping = nullptr;
+	uint64_t offset = 0;
+#endif
+};
+
+class OutputFile {
+public:
+
+	~OutputFile();
+
+	bool create(const std::string& filePath);
+	void close();
+	bool write(const char* const& data, const uint64_t& size);
+	bool flush();
+
+private:
+
+#ifdef _WIN32
+	HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+	int descriptor = -1;
+#endif
+};
+
+class LargeStackThread {
+public:
+
+	~LargeStackThread();
+
+	bool start(void (* const& function)(void* const&), void* const& argument);
+	void join();
+
+private:
+
+	void (* function)(void* const&) = nullptr;
+	void* argument = nullptr;
+#ifdef _WIN32
+	HANDLE handle = NULL;
+#else
+	pthread_t thread;
+	bool isRunning = false;
+#endif
+};
+
+int run_main_thread(int (* const& function)(int, char**), const int& argc, char** const& argv);
+void run_large_stack_thread(void (* const& function)(void* const&), void* const& argument);
+bool initialize_console();
+void write_console(const char* const& string, const uint32_t& size);
+void write_error_console(const char* const& string, const uint32_t& size);
+bool read_standard_input(std::vector<uint8_t>& data);
+bool write_standard_output(const char* const& data, const uint64_t& size);
+void wait_for_key();
+PATH_TYPE get_path_type(const std::string& path);
+bool read_directory(const std::string& path, std::vector<DirectoryEntry>& entries);
+void create_directory(const std::string& path);
+uint32_t get_process_id();
+bool rename_file(const std::string& sourcePath, const std::string& targetPath);
+void delete_file(const std::string& filePath);
+std::string get_executable_directory();
+bool show_open_file_dialog(std::string& filePath);
+DIALOG_RESULT show_error_dialog(const std::string& message);
+void show_fatal_error_dialog(const std::string& message);
+bool show_overwrite_dialog(const std::string& filePath);
+#ifdef PLATFORM_X86
+void get_cpuid(int (&cpuInfo)[4], const int& leaf, const int& subleaf = 0);
+uint64_t get_xcr0();
+#endif
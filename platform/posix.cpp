@@ -0,0 +1,323 @@
+#include "../main.h"
+
+#ifndef _WIN32
+static constexpr size_t MAIN_THREAD_STACK_SIZE = 268435456;
+
+#ifdef __linux__
+struct LinuxDirent64 {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+#endif
+
+InputFile::~InputFile() {
+	close();
+}
+
+bool InputFile::open(const std::string& filePath) {
+	descriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor == -1) return false;
+	struct stat fileStatus;
+	if (fstat(descriptor, &fileStatus) || !S_ISREG(fileStatus.st_mode)) return false;
+	size = fileStatus.st_size;
+	offset = 0;
+	posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+	if (!size) return true;
+	void* const fileMapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (fileMapping != MAP_FAILED) mapping = (uint8_t*)fileMapping;
+	return true;
+}
+
+void InputFile::close() {
+	if (mapping) {
+		munmap(mapping, size);
+		mapping = nullptr;
+	}
+
+	if (descriptor == -1) return;
+	::close(descriptor);
+	descriptor = -1;
+}
+
+bool InputFile::read(uint8_t* const& buffer, const uint32_t& byteCount) {
+	if (offset + byteCount > size) return false;
+
+	if (mapping) {
+		std::memcpy(buffer, mapping + offset, byteCount);
+		offset += byteCount;
+		return true;
+	}
+
+	ssize_t bytesRead;
+
+	for (uint32_t i = 0; i < byteCount; i += bytesRead) {
+		bytesRead = pread(descriptor, buffer + i, byteCount - i, offset + i);
+
+		if (bytesRead <= 0) {
+			if (bytesRead == -1 && errno == EINTR) {
+				bytesRead = 0;
+				continue;
+			}
+
+			return false;
+		}
+	}
+
+	offset += byteCount;
+	return true;
+}
+
+OutputFile::~OutputFile() {
+	close();
+}
+
+bool OutputFile::create(const std::string& filePath) {
+	descriptor = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	return descriptor != -1;
+}
+
+void OutputFile::close() {
+	if (descriptor == -1) return;
+	::close(descriptor);
+	descriptor = -1;
+}
+
+bool OutputFile::write(const char* const& data, const uint64_t& size) {
+	ssize_t charsWritten;
+
+	for (uint64_t i = 0; i < size; i += charsWritten) {
+		charsWritten = ::write(descriptor, data + i, size - i);
+
+		if (charsWritten <= 0) {
+			if (charsWritten == -1 && errno == EINTR) {
+				charsWritten = 0;
+				continue;
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool OutputFile::flush() {
+	while (::fsync(descriptor) == -1) {
+		if (errno != EINTR) return false;
+	}
+
+	return true;
+}
+
+int run_main_thread(int (* const& function)(int, char**), const int& argc, char** const& argv) {
+	struct MainThread {
+		int (* const function)(int, char**);
+		const int argc;
+		char** const argv;
+		int result = EXIT_FAILURE;
+	} mainThread = { .function = function, .argc = argc, .argv = argv };
+
+	run_large_stack_thread([](void* const& argument) {
+		MainThread& mainThread = *(MainThread*)argument;
+		mainThread.result = mainThread.function(mainThread.argc, mainThread.argv);
+	}, &mainThread);
+
+	return mainThread.result;
+}
+
+LargeStackThread::~LargeStackThread() {
+	join();
+}
+
+bool LargeStackThread::start(void (* const& function)(void* const&), void* const& argument) {
+	this->function = function;
+	this->argument = argument;
+	pthread_attr_t attributes;
+	if (pthread_attr_init(&attributes)) return false;
+
+	isRunning = !pthread_attr_setstacksize(&attributes, MAIN_THREAD_STACK_SIZE) && !pthread_create(&thread, &attributes, [](void* thread)->void* {
+		((LargeStackThread*)thread)->function(((LargeStackThread*)thread)->argument);
+		return nullptr;
+	}, this);
+
+	pthread_attr_destroy(&attributes);
+	return isRunning;
+}
+
+void LargeStackThread::join() {
+	if (!isRunning) return;
+	pthread_join(thread, nullptr);
+	isRunning = false;
+}
+
+void run_large_stack_thread(void (* const& function)(void* const&), void* const& argument) {
+	LargeStackThread thread;
+	if (!thread.start(function, argument)) return function(argument);
+	thread.join();
+}
+
+bool initialize_console() {
+	return true;
+}
+
+static bool write_descriptor(const int& descriptor, const char* const& data, const uint64_t& size) {
+	ssize_t bytesWritten;
+
+	for (uint64_t i = 0; i < size; i += bytesWritten) {
+		bytesWritten = ::write(descriptor, data + i, size - i);
+
+		if (bytesWritten <= 0) {
+			if (bytesWritten == -1 && errno == EINTR) {
+				bytesWritten = 0;
+				continue;
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void write_console(const char* const& string, const uint32_t& size) {
+	write_descriptor(STDOUT_FILENO, string, size);
+}
+
+void write_error_console(const char* const& string, const uint32_t& size) {
+	write_descriptor(STDERR_FILENO, string, size);
+}
+
+bool read_standard_input(std::vector<uint8_t>& data) {
+	static constexpr uint32_t READ_SIZE = 0x10000;
+	ssize_t bytesRead;
+	data.clear();
+
+	while (true) {
+		data.resize(data.size() + READ_SIZE);
+		bytesRead = ::read(STDIN_FILENO, data.data() + data.size() - READ_SIZE, READ_SIZE);
+		data.resize(data.size() - READ_SIZE + (bytesRead > 0 ? bytesRead : 0));
+		if (!bytesRead) return true;
+		if (bytesRead == -1 && errno != EINTR) return false;
+	}
+}
+
+bool write_standard_output(const char* const& data, const uint64_t& size) {
+	return write_descriptor(STDOUT_FILENO, data, size);
+}
+
+void wait_for_key() {}
+
+PATH_TYPE get_path_type(const std::string& path) {
+	struct stat pathStatus;
+	if (stat(path.c_str(), &pathStatus)) return PATH_INVALID;
+	return S_ISDIR(pathStatus.st_mode) ? PATH_DIRECTORY : PATH_FILE;
+}
+
+bool read_directory(const std::string& path, std::vector<DirectoryEntry>& entries) {
+	const auto add_entry = [&entries](const int& descriptor, const char* const& name, const unsigned char& type)->void {
+		if (!std::strcmp(name, ".") || !std::strcmp(name, "..")) return;
+		struct stat entryStatus;
+
+		switch (type) {
+		case DT_DIR:
+			entries.emplace_back(DirectoryEntry{ .name = name, .isDirectory = true });
+			return;
+		case DT_REG:
+			entries.emplace_back(DirectoryEntry{ .name = name, .isDirectory = false });
+			return;
+		case DT_LNK:
+		case DT_UNKNOWN:
+			if (fstatat(descriptor, name, &entryStatus, 0)) return;
+			entries.emplace_back(DirectoryEntry{ .name = name, .isDirectory = S_ISDIR(entryStatus.st_mode) });
+			return;
+		}
+	};
+
+	const int descriptor = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (descriptor == -1) return false;
+#ifdef __linux__
+	alignas(LinuxDirent64) static thread_local char BUFFER[65536];
+
+	long bytesRead;
+
+	while ((bytesRead = syscall(SYS_getdents64, descriptor, BUFFER, sizeof(BUFFER))) > 0) {
+		for (long i = 0; i < bytesRead; i += ((LinuxDirent64*)(BUFFER + i))->d_reclen) {
+			add_entry(descriptor, ((LinuxDirent64*)(BUFFER + i))->d_name, ((LinuxDirent64*)(BUFFER + i))->d_type);
+		}
+	}
+
+	::close(descriptor);
+	return !bytesRead;
+#else
+	DIR* const directory = fdopendir(descriptor);
+
+	if (!directory) {
+		::close(descriptor);
+		return false;
+	}
+
+	for (const dirent* entry = readdir(directory); entry; entry = readdir(directory)) {
+		add_entry(descriptor, entry->d_name, entry->d_type);
+	}
+
+	closedir(directory);
+	return true;
+#endif
+}
+
+void create_directory(const std::string& path) {
+	mkdir(path.c_str(), 0755);
+}
+
+uint32_t get_process_id() {
+	return getpid();
+}
+
+bool rename_file(const std::string& sourcePath, const std::string& targetPath) {
+	return !rename(sourcePath.c_str(), targetPath.c_str());
+}
+
+void delete_file(const std::string& filePath) {
+	unlink(filePath.c_str());
+}
+
+std::string get_executable_directory() {
+	std::string path(PATH_MAX, '\x00');
+	const ssize_t size = readlink("/proc/self/exe", path.data(), path.size() - 1);
+	if (size <= 0) return "";
+	path.resize(size);
+	path.resize(path.find_last_of(PATH_SEPARATORS) + 1);
+	return path;
+}
+
+bool show_open_file_dialog(std::string& filePath) {
+	return false;
+}
+
+DIALOG_RESULT show_error_dialog(const std::string& message) {
+	return DIALOG_UNAVAILABLE;
+}
+
+void show_fatal_error_dialog(const std::string& message) {
+	std::fputs((message + '\n').c_str(), stderr);
+}
+
+bool show_overwrite_dialog(const std::string& filePath) {
+	return false;
+}
+
+#ifdef PLATFORM_X86
+void get_cpuid(int (&cpuInfo)[4], const int& leaf, const int& subleaf) {
+	__cpuid_count(leaf, subleaf, cpuInfo[0], cpuInfo[1], cpuInfo[2], cpuInfo[3]);
+}
+
+uint64_t get_xcr0() {
+	uint32_t low, high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return (uint64_t)high << 32 | low;
+}
+#endif
+#endif
@@ -0,0 +1,239 @@
+#include "../main.h"
+
+#ifdef _WIN32
+static const HANDLE CONSOLE_OUTPUT = GetStdHandle(STD_OUTPUT_HANDLE);
+static constexpr SIZE_T LARGE_STACK_SIZE = 268435456;
+
+InputFile::~InputFile() {
+	close();
+}
+
+bool InputFile::open(const std::string& filePath) {
+	handle = CreateFileA(filePath.c_str(), GENERIC_READ, NULL, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize)) return false;
+	size = fileSize.QuadPart;
+	return true;
+}
+
+void InputFile::close() {
+	if (handle == INVALID_HANDLE_VALUE) return;
+	CloseHandle(handle);
+	handle = INVALID_HANDLE_VALUE;
+}
+
+bool InputFile::read(uint8_t* const& buffer, const uint32_t& byteCount) {
+	DWORD bytesRead = 0;
+	return ReadFile(handle, buffer, byteCount, &bytesRead, NULL) && bytesRead == byteCount;
+}
+
+OutputFile::~OutputFile() {
+	close();
+}
+
+bool OutputFile::create(const std::string& filePath) {
+	handle = CreateFileA(filePath.c_str(), GENERIC_WRITE, NULL, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	return handle != INVALID_HANDLE_VALUE;
+}
+
+void OutputFile::close() {
+	if (handle == INVALID_HANDLE_VALUE) return;
+	CloseHandle(handle);
+	handle = INVALID_HANDLE_VALUE;
+}
+
+bool OutputFile::write(const char* const& data, const uint64_t& size) {
+	DWORD charsWritten = 0;
+	return WriteFile(handle, data, size, &charsWritten, NULL) && charsWritten == size;
+}
+
+bool OutputFile::flush() {
+	return FlushFileBuffers(handle);
+}
+
+int run_main_thread(int (* const& function)(int, char**), const int& argc, char** const& argv) {
+	return function(argc, argv);
+}
+
+LargeStackThread::~LargeStackThread() {
+	join();
+}
+
+bool LargeStackThread::start(void (* const& function)(void* const&), void* const& argument) {
+	this->function = function;
+	this->argument = argument;
+
+	handle = CreateThread(NULL, LARGE_STACK_SIZE, [](LPVOID thread)->DWORD {
+		((LargeStackThread*)thread)->function(((LargeStackThread*)thread)->argument);
+		return 0;
+	}, this, STACK_SIZE_PARAM_IS_A_RESERVATION, NULL);
+
+	return handle;
+}
+
+void LargeStackThread::join() {
+	if (!handle) return;
+	WaitForSingleObject(handle, INFINITE);
+	CloseHandle(handle);
+	handle = NULL;
+}
+
+void run_large_stack_thread(void (* const& function)(void* const&), void* const& argument) {
+	LargeStackThread thread;
+	if (!thread.start(function, argument)) return function(argument);
+	thread.join();
+}
+
+bool initialize_console() {
+	SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+	HWND window = GetConsoleWindow();
+	DWORD consoleProcessId;
+	GetWindowThreadProcessId(window, &consoleProcessId);
+#ifdef _DEBUG
+	return false;
+#else
+	if (consoleProcessId != GetCurrentProcessId()) return true;
+	SetWindowTextA(window, PROGRAM_NAME);
+	return false;
+#endif
+}
+
+void write_console(const char* const& string, const uint32_t& size) {
+	WriteConsoleA(CONSOLE_OUTPUT, string, size, NULL, NULL);
+}
+
+void write_error_console(const char* const& string, const uint32_t& size) {
+	DWORD bytesWritten;
+	WriteFile(GetStdHandle(STD_ERROR_HANDLE), string, size, &bytesWritten, NULL);
+}
+
+bool read_standard_input(std::vector<uint8_t>& data) {
+	static constexpr DWORD READ_SIZE = 0x10000;
+	const HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+	DWORD bytesRead;
+	data.clear();
+
+	while (true) {
+		data.resize(data.size() + READ_SIZE);
+
+		if (!ReadFile(input, data.data() + data.size() - READ_SIZE, READ_SIZE, &bytesRead, NULL)) {
+			data.resize(data.size() - READ_SIZE);
+			return GetLastError() == ERROR_BROKEN_PIPE;
+		}
+
+		data.resize(data.size() - READ_SIZE + bytesRead);
+		if (!bytesRead) return true;
+	}
+}
+
+bool write_standard_output(const char* const& data, const uint64_t& size) {
+	const HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD bytesWritten;
+
+	for (uint64_t i = 0; i < size; i += bytesWritten) {
+		if (!WriteFile(output, data + i, size - i < MAXDWORD ? size - i : MAXDWORD, &bytesWritten, NULL)) return false;
+	}
+
+	return true;
+}
+
+void wait_for_key() {
+	while (!_kbhit()) {
+		Sleep(0);
+	};
+}
+
+PATH_TYPE get_path_type(const std::string& path) {
+	const DWORD pathAttributes = GetFileAttributesA(path.c_str());
+	if (pathAttributes == INVALID_FILE_ATTRIBUTES) return PATH_INVALID;
+	return pathAttributes & FILE_ATTRIBUTE_DIRECTORY ? PATH_DIRECTORY : PATH_FILE;
+}
+
+bool read_directory(const std::string& path, std::vector<DirectoryEntry>& entries) {
+	WIN32_FIND_DATAA pathData;
+	HANDLE handle = FindFirstFileA((path + '*').c_str(), &pathData);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	do {
+		if (!std::strcmp(pathData.cFileName, ".") || !std::strcmp(pathData.cFileName, "..")) continue;
+		entries.emplace_back(DirectoryEntry{ .name = pathData.cFileName, .isDirectory = (pathData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 });
+	} while (FindNextFileA(handle, &pathData));
+
+	FindClose(handle);
+	return true;
+}
+
+void create_directory(const std::string& path) {
+	CreateDirectoryA(path.c_str(), NULL);
+}
+
+uint32_t get_process_id() {
+	return GetCurrentProcessId();
+}
+
+bool rename_file(const std::string& sourcePath, const std::string& targetPath) {
+	return MoveFileExA(sourcePath.c_str(), targetPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+void delete_file(const std::string& filePath) {
+	DeleteFileA(filePath.c_str());
+}
+
+std::string get_executable_directory() {
+	std::string path(MAX_PATH, '\x00');
+	GetModuleFileNameA(NULL, path.data(), path.size());
+	*PathFindFileNameA(path.data()) = '\x00';
+	return path.c_str();
+}
+
+bool show_open_file_dialog(std::string& filePath) {
+	filePath.resize(MAX_PATH, NULL);
+	OPENFILENAMEA dialogInfo = {
+		.lStructSize = sizeof(OPENFILENAMEA),
+		.hwndOwner = NULL,
+		.lpstrFilter = NULL,
+		.lpstrCustomFilter = NULL,
+		.lpstrFile = filePath.data(),
+		.nMaxFile = (DWORD)filePath.size(),
+		.lpstrFileTitle = NULL,
+		.lpstrInitialDir = NULL,
+		.lpstrTitle = PROGRAM_NAME,
+		.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST,
+		.lpstrDefExt = NULL,
+		.FlagsEx = NULL
+	};
+	if (!GetOpenFileNameA(&dialogInfo)) return false;
+	filePath = filePath.c_str();
+	return true;
+}
+
+DIALOG_RESULT show_error_dialog(const std::string& message) {
+	switch (MessageBoxA(NULL, message.c_str(), PROGRAM_NAME, MB_ICONERROR | MB_CANCELTRYCONTINUE | MB_DEFBUTTON3)) {
+	case IDTRYAGAIN:
+		return DIALOG_RETRY;
+	case IDCONTINUE:
+		return DIALOG_CONTINUE;
+	}
+
+	return DIALOG_CANCEL;
+}
+
+void show_fatal_error_dialog(const std::string& message) {
+	MessageBoxA(NULL, message.c_str(), PROGRAM_NAME, MB_ICONERROR | MB_OK);
+}
+
+bool show_overwrite_dialog(const std::string& filePath) {
+	return MessageBoxA(NULL, ("The file " + filePath + " already exists.\n\nDo you want to overwrite it?").c_str(), PROGRAM_NAME, MB_ICONWARNING | MB_YESNO | MB_DEFBUTTON2) == IDYES;
+}
+
+#ifdef PLATFORM_X86
+void get_cpuid(int (&cpuInfo)[4], const int& leaf, const int& subleaf) {
+	__cpuidex(cpuInfo, leaf, subleaf);
+}
+
+uint64_t get_xcr0() {
+	return _xgetbv(0);
+}
+#endif
+#endif
@@ -0,0 +1,46 @@
+template <typename T>
+class BoundedQueue {
+public:
+
+	BoundedQueue(const uint32_t& capacity) : capacity(capacity) {}
+
+	bool push(T&& value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this] { return isClosed || values.size() < capacity; });
+		if (isClosed) return false;
+		values.emplace_back(std::move(value));
+		lock.unlock();
+		notEmpty.notify_one();
+		return true;
+	}
+
+	bool pop(T& value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this] { return isClosed || values.size(); });
+		if (!values.size()) return false;
+		value = std::move(values.front());
+		values.pop_front();
+		lock.unlock();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close() {
+		{
+			const std::lock_guard<std::mutex> lock(mutex);
+			isClosed = true;
+		}
+
+		notEmpty.notify_all();
+		notFull.notify_all();
+	}
+
+private:
+
+	const uint32_t capacity;
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	std::deque<T> values;
+	bool isClosed = false;
+};
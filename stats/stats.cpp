@@ -0,0 +1,207 @@
+#include "../main.h"
+
+Stats::Scope::Scope(Stats* const& stats, const PASS& pass) : stats(stats) {
+	if (!stats) return;
+	stats->activePasses.emplace_back(ActivePass{ .pass = pass, .begin = std::chrono::steady_clock::now() });
+}
+
+Stats::Scope::~Scope() {
+	if (!stats) return;
+	const ActivePass activePass = stats->activePasses.back();
+	const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - activePass.begin).count();
+	stats->activePasses.pop_back();
+	if (stats->activePasses.size()) stats->activePasses.back().childTime += time;
+	if (stats->activeFunction == INVALID_FUNCTION) return;
+	Counters& counters = stats->functions[stats->activeFunction].passes[activePass.pass];
+	counters.time += time - activePass.childTime;
+	counters.calls++;
+}
+
+Stats::Stats(const std::string& filePath) : filePath(filePath) {}
+
+void Stats::Counters::add(const Counters& counters) {
+	time += counters.time;
+	calls += counters.calls;
+	statements += counters.statements;
+	expressions += counters.expressions;
+	erases += counters.erases;
+	shiftedElements += counters.shiftedElements;
+}
+
+void Stats::begin_function(const uint32_t& id, const uint32_t& instructions) {
+	activeFunction = functions.size();
+	functions.emplace_back();
+	functions.back().id = id;
+	functions.back().instructions = instructions;
+	functions.back().peakNodes = liveNodes;
+}
+
+void Stats::end_function() {
+	activeFunction = INVALID_FUNCTION;
+}
+
+void Stats::add_statement() {
+	add_node();
+	if (activeFunction == INVALID_FUNCTION || !activePasses.size()) return;
+	get_counters().statements++;
+}
+
+void Stats::add_expression() {
+	add_node();
+	if (activeFunction == INVALID_FUNCTION || !activePasses.size()) return;
+	get_counters().expressions++;
+}
+
+void Stats::add_erase(const uint64_t& shiftedElements) {
+	if (activeFunction == INVALID_FUNCTION || !activePasses.size()) return;
+	Counters& counters = get_counters();
+	counters.erases++;
+	counters.shiftedElements += shiftedElements;
+}
+
+void Stats::release_nodes(const uint64_t& count) {
+	liveNodes -= count;
+}
+
+Stats::Counters& Stats::get_counters() {
+	return functions[activeFunction].passes[activePasses.back().pass];
+}
+
+void Stats::add_node() {
+	liveNodes++;
+	if (liveNodes > peakNodes) peakNodes = liveNodes;
+	if (activeFunction != INVALID_FUNCTION && liveNodes > functions[activeFunction].peakNodes) functions[activeFunction].peakNodes = liveNodes;
+}
+
+std::string Stats::to_string(const FORMAT& format) const {
+	switch (format) {
+	case FORMAT_TABLE:
+		return to_table();
+	case FORMAT_JSON:
+		return to_json();
+	}
+
+	return "";
+}
+
+std::string Stats::to_table() const {
+	char buffer[256];
+	Counters passTotals[PASS_COUNT];
+	Counters total;
+
+	for (uint32_t i = 0; i < functions.size(); i++) {
+		for (uint8_t j = 0; j < PASS_COUNT; j++) {
+			passTotals[j].add(functions[i].passes[j]);
+		}
+	}
+
+	std::string string = "Stats: " + filePath + "\n";
+	std::snprintf(buffer, sizeof(buffer), "%-24s%12s%10s%12s%12s%10s%12s\n", "Pass", "Time (ms)", "Calls", "Statements", "Expressions", "Erases", "Shifted");
+	string += buffer;
+
+	for (uint8_t i = 0; i < PASS_COUNT; i++) {
+		total.add(passTotals[i]);
+		std::snprintf(buffer, sizeof(buffer), "%-24s%12.3f%10" PRIu64 "%12" PRIu64 "%12" PRIu64 "%10" PRIu64 "%12" PRIu64 "\n", PASS_NAMES[i], passTotals[i].time / 1e6, passTotals[i].calls,
+			passTotals[i].statements, passTotals[i].expressions, passTotals[i].erases, passTotals[i].shiftedElements);
+		string += buffer;
+	}
+
+	std::snprintf(buffer, sizeof(buffer), "%-24s%12.3f%10" PRIu64 "%12" PRIu64 "%12" PRIu64 "%10" PRIu64 "%12" PRIu64 "\n\n", "Total", total.time / 1e6, total.calls,
+		total.statements, total.expressions, total.erases, total.shiftedElements);
+	string += buffer;
+	std::snprintf(buffer, sizeof(buffer), "%-10s%14s%12s%12s%12s%10s%12s  %s\n", "Function", "Instructions", "Time (ms)", "Statements", "Expressions", "Erases", "Peak nodes", "Slowest pass");
+	string += buffer;
+	uint8_t slowestPass;
+
+	for (uint32_t i = 0; i < functions.size(); i++) {
+		total = Counters();
+		slowestPass = 0;
+
+		for (uint8_t j = 0; j < PASS_COUNT; j++) {
+			total.add(functions[i].passes[j]);
+			if (functions[i].passes[j].time > functions[i].passes[slowestPass].time) slowestPass = j;
+		}
+
+		std::snprintf(buffer, sizeof(buffer), "%-10u%14u%12.3f%12" PRIu64 "%12" PRIu64 "%10" PRIu64 "%12" PRIu64 "  %s\n", functions[i].id, functions[i].instructions, total.time / 1e6,
+			total.statements, total.expressions, total.erases, functions[i].peakNodes, PASS_NAMES[slowestPass]);
+		string += buffer;
+	}
+
+	return string + "Peak nodes: " + std::to_string(peakNodes);
+}
+
+std::string Stats::to_json() const {
+	const auto write_counters = [](std::string& string, const Counters* const& counters)->void {
+		bool isFirstPass = true;
+		string += "{";
+
+		for (uint8_t i = 0; i < PASS_COUNT; i++) {
+			if (!counters[i].calls) continue;
+			if (!isFirstPass) string += ",";
+			isFirstPass = false;
+			string += "\"" + std::string(PASS_NAMES[i]) + "\":{\"time_ns\":" + std::to_string(counters[i].time)
+				+ ",\"calls\":" + std::to_string(counters[i].calls)
+				+ ",\"statements\":" + std::to_string(counters[i].statements)
+				+ ",\"expressions\":" + std::to_string(counters[i].expressions)
+				+ ",\"erases\":" + std::to_string(counters[i].erases)
+				+ ",\"shifted\":" + std::to_string(counters[i].shiftedElements) + "}";
+		}
+
+		string += "}";
+	};
+
+	Counters passTotals[PASS_COUNT];
+	std::string string = "{\"file\":\"";
+	char escape[7];
+
+	for (uint32_t i = 0; i < filePath.size(); i++) {
+		switch (filePath[i]) {
+		case '"':
+			string += "\\\"";
+			continue;
+		case '\\':
+			string += "\\\\";
+			continue;
+		case '\b':
+			string += "\\b";
+			continue;
+		case '\f':
+			string += "\\f";
+			continue;
+		case '\n':
+			string += "\\n";
+			continue;
+		case '\r':
+			string += "\\r";
+			continue;
+		case '\t':
+			string += "\\t";
+			continue;
+		}
+
+		if ((uint8_t)filePath[i] < 0x20) {
+			std::snprintf(escape, sizeof(escape), "\\u%04X", (uint8_t)filePath[i]);
+			string += escape;
+			continue;
+		}
+
+		string += filePath[i];
+	}
+
+	string += "\",\"peak_nodes\":" + std::to_string(peakNodes) + ",\"functions\":[";
+
+	for (uint32_t i = 0; i < functions.size(); i++) {
+		if (i) string += ",";
+		string += "{\"id\":" + std::to_string(functions[i].id) + ",\"instructions\":" + std::to_string(functions[i].instructions) + ",\"peak_nodes\":" + std::to_string(functions[i].peakNodes) + ",\"passes\":";
+		write_counters(string, functions[i].passes);
+		string += "}";
+
+		for (uint8_t j = 0; j < PASS_COUNT; j++) {
+			passTotals[j].add(functions[i].passes[j]);
+		}
+	}
+
+	string += "],\"passes\":";
+	write_counters(string, passTotals);
+	return string + "}";
+}
@@ -0,0 +1,114 @@
+#ifdef DISABLE_STATS
+#define STATS_PASS(pass)
+#define STATS_BEGIN_FUNCTION(function)
+#define STATS_END_FUNCTION()
+#define STATS_STATEMENT()
+#define STATS_EXPRESSION()
+#define STATS_ERASE(block, eraseEnd)
+#define STATS_RELEASE(count)
+#else
+#define STATS_PASS(pass) const Stats::Scope statsScope(stats, Stats::pass)
+#define STATS_BEGIN_FUNCTION(function) if (stats) stats->begin_function(function.id, function.prototype.instructions.size())
+#define STATS_END_FUNCTION() if (stats) stats->end_function()
+#define STATS_STATEMENT() if (stats) stats->add_statement()
+#define STATS_EXPRESSION() if (stats) stats->add_expression()
+#define STATS_ERASE(block, eraseEnd) if (stats) stats->add_erase((block).size() - (eraseEnd))
+#define STATS_RELEASE(count) if (stats) stats->release_nodes(count)
+#endif
+
+class Stats {
+public:
+
+	enum PASS {
+		PASS_BUILD_INSTRUCTIONS,
+		PASS_ASSIGN_DEBUG_INFO,
+		PASS_GROUP_JUMPS,
+		PASS_BUILD_LOOPS,
+		PASS_BUILD_LOCAL_SCOPES,
+		PASS_BUILD_EXPRESSIONS,
+		PASS_BUILD_SLOT_SCOPES,
+		PASS_ELIMINATE_SLOTS,
+		PASS_ELIMINATE_CONDITIONS,
+		PASS_BUILD_MULTI_ASSIGNMENT,
+		PASS_BUILD_IF_STATEMENTS,
+		PASS_CLEAN_UP,
+		PASS_COUNT
+	};
+
+	enum FORMAT {
+		FORMAT_TABLE,
+		FORMAT_JSON
+	};
+
+	struct Scope {
+		Scope(Stats* const& stats, const PASS& pass);
+		~Scope();
+
+		Stats* const stats;
+	};
+
+	Stats(const std::string& filePath);
+
+	void begin_function(const uint32_t& id, const uint32_t& instructions);
+	void end_function();
+	void add_statement();
+	void add_expression();
+	void add_erase(const uint64_t& shiftedElements);
+	void release_nodes(const uint64_t& count);
+	std::string to_string(const FORMAT& format) const;
+
+	const std::string filePath;
+
+private:
+
+	static constexpr uint32_t INVALID_FUNCTION = -1;
+	static constexpr const char* PASS_NAMES[PASS_COUNT] = {
+		"build_instructions",
+		"assign_debug_info",
+		"group_jumps",
+		"build_loops",
+		"build_local_scopes",
+		"build_expressions",
+		"build_slot_scopes",
+		"eliminate_slots",
+		"eliminate_conditions",
+		"build_multi_assignment",
+		"build_if_statements",
+		"clean_up"
+	};
+
+	struct Counters {
+		uint64_t time = 0;
+		uint64_t calls = 0;
+		uint64_t statements = 0;
+		uint64_t expressions = 0;
+		uint64_t erases = 0;
+		uint64_t shiftedElements = 0;
+
+		void add(const Counters& counters);
+	};
+
+	struct Function {
+		uint32_t id = 0;
+		uint32_t instructions = 0;
+		uint64_t peakNodes = 0;
+		Counters passes[PASS_COUNT];
+	};
+
+	struct ActivePass {
+		PASS pass;
+		std::chrono::steady_clock::time_point begin;
+		uint64_t childTime = 0;
+	};
+
+	Counters& get_counters();
+	void add_node();
+	std::string to_table() const;
+	std::string to_json() const;
+
+	std::vector<Function> functions;
+	std::vector<ActivePass> activePasses;
+	uint32_t activeFunction = INVALID_FUNCTION;
+	uint64_t liveNodes = 0;
+	uint64_t peakNodes = 0;
+};
@@ -0,0 +1,89 @@
+#include "../main.h"
+
+#include <random>
+
+// The snprintf/std::stod retry loop Lua::write_number used before Lua::format_number.
+static void write_number_snprintf(std::string& buffer, const double& number) {
+	static const auto try_string_to_number = [](const std::string& string, const double& number)->bool {
+		try {
+			return std::stod(string) == number;
+		} catch (...) {
+			return false;
+		}
+	};
+
+	std::string string;
+	string.resize(std::snprintf(nullptr, 0, "%1.15g", number));
+	std::snprintf(string.data(), string.size() + 1, "%1.15g", number);
+
+	if (!try_string_to_number(string, number)) {
+		string.resize(std::snprintf(nullptr, 0, "%1.16g", number));
+		std::snprintf(string.data(), string.size() + 1, "%1.16g", number);
+
+		if (!try_string_to_number(string, number)) {
+			string.resize(std::snprintf(nullptr, 0, "%1.17g", number));
+			std::snprintf(string.data(), string.size() + 1, "%1.17g", number);
+		}
+	}
+
+	buffer += string;
+}
+
+static void write_number(std::string& buffer, const double& number) {
+	const uint64_t size = buffer.size();
+	buffer.resize(size + Lua::MAX_NUMBER_SIZE);
+	buffer.resize(Lua::format_number(buffer.data() + size, number) - buffer.data());
+}
+
+template <typename Writer>
+static double time_writer(const Writer& writer, const std::vector<double>& numbers, const uint32_t& runCount, uint64_t& outputSize) {
+	std::string buffer;
+	double bestTime = 0;
+
+	for (uint32_t i = 0; i < runCount; i++) {
+		buffer.clear();
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (uint32_t j = 0; j < numbers.size(); j++) {
+			writer(buffer, numbers[j]);
+			buffer += ',';
+		}
+
+		const double time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		if (!i || time < bestTime) bestTime = time;
+	}
+
+	outputSize = buffer.size();
+	return bestTime;
+}
+
+// Times Lua::format_number against the old snprintf/std::stod path on a mix of short decimals, scaled integers and random doubles.
+int main(int argc, char* argv[]) {
+	const uint32_t numberCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	const uint32_t runCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+	std::mt19937_64 random(0x5EED);
+	std::vector<double> numbers;
+	numbers.reserve(numberCount);
+
+	for (uint32_t i = 0; i < numberCount; i++) {
+		switch (i % 3) {
+		case 0:
+			numbers.emplace_back((double)(random() % 1000000) / 100);
+			break;
+		case 1:
+			numbers.emplace_back(std::ldexp((double)(random() >> 11), (int32_t)(random() % 128) - 64 - 53));
+			break;
+		default:
+			numbers.emplace_back(std::bit_cast<double>((random() & ~DOUBLE_EXPONENT) | (random() % 0x7FE + 1) << 52));
+			break;
+		}
+	}
+
+	uint64_t oldSize, newSize;
+	const double oldTime = time_writer(write_number_snprintf, numbers, runCount, oldSize);
+	const double newTime = time_writer(write_number, numbers, runCount, newSize);
+	std::printf("%" PRIu32 " numbers, best of %" PRIu32 " runs\n", numberCount, runCount);
+	std::printf("snprintf/stod:  %8.1f ms, %6.1f ns per number, %" PRIu64 " bytes\n", oldTime / 1e6, oldTime / numberCount, oldSize);
+	std::printf("format_number:  %8.1f ms, %6.1f ns per number, %" PRIu64 " bytes\n", newTime / 1e6, newTime / numberCount, newSize);
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include "../main.h"
+
+#include <cfloat>
+#include <random>
+
+// Checks that every number written by Lua::format_number parses back to the same bits and,
+// for normal numbers, matches printf %.Ng with N = max(shortest digits, 15) whenever that round-trips.
+int main() {
+	std::vector<double> numbers = { 0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0 / 3, 2.0 / 3, 1e15, 1e16, 1e17, 1234500.0, 0.0001, 0.00012345, 1e-5,
+		123456789012345678.0, DBL_MIN, DBL_MAX, DBL_EPSILON, DBL_TRUE_MIN, -DBL_MAX };
+
+	for (uint64_t i = 1e14; i < 1e18; i *= 10) {
+		numbers.insert(numbers.end(), { (double)i, (double)(i + 1), (double)(i - 1), std::nextafter((double)i, 0.0), std::nextafter((double)i, 1e300) });
+	}
+
+	for (int32_t i = -1074; i <= 1023; i++) {
+		numbers.insert(numbers.end(), { std::ldexp(1.0, i), -std::ldexp(1.0, i), std::nextafter(std::ldexp(1.0, i), 0.0), std::nextafter(std::ldexp(1.0, i), 1e300) });
+	}
+
+	for (int32_t i = -30; i < 30; i++) {
+		for (uint32_t j = 1; j < 1000; j++) {
+			numbers.insert(numbers.end(), { j * std::pow(10.0, i), j / 7.0 * std::pow(10.0, i) });
+		}
+	}
+
+	std::mt19937_64 random(0x5EED);
+
+	for (uint32_t i = 0; i < 2000000; i++) {
+		numbers.emplace_back(std::bit_cast<double>(random() & (DOUBLE_SIGN | DOUBLE_FRACTION)));
+		numbers.emplace_back(std::bit_cast<double>(random()));
+		if ((std::bit_cast<uint64_t>(numbers.back()) & DOUBLE_EXPONENT) == DOUBLE_SPECIAL) numbers.pop_back();
+	}
+
+	char string[Lua::MAX_NUMBER_SIZE];
+	char expectedString[32];
+	char* stringEnd;
+	uint32_t failures = 0;
+	int32_t precision;
+	double number;
+
+	for (uint32_t i = 0; i < numbers.size(); i++) {
+		stringEnd = Lua::format_number(string, numbers[i]);
+		const std::from_chars_result result = std::from_chars(string, stringEnd, number);
+
+		if (result.ec != std::errc() || result.ptr != stringEnd || std::bit_cast<uint64_t>(number) != std::bit_cast<uint64_t>(numbers[i])) {
+			std::fprintf(stderr, "%016" PRIX64 " (%.17g) was written as %.*s\n", std::bit_cast<uint64_t>(numbers[i]), numbers[i], (int)(stringEnd - string), string);
+			failures++;
+			continue;
+		}
+
+		if (!(std::bit_cast<uint64_t>(numbers[i]) & DOUBLE_EXPONENT)) continue;
+		char* const digits = expectedString + (numbers[i] < 0);
+		precision = std::find(digits, std::to_chars(expectedString, expectedString + sizeof(expectedString), numbers[i], std::chars_format::scientific).ptr, 'e') - digits;
+		if (precision > 1) precision--;
+		std::snprintf(expectedString, sizeof(expectedString), "%.*g", precision < 15 ? 15 : precision, numbers[i]);
+		if (std::strtod(expectedString, nullptr) != numbers[i] || (std::strlen(expectedString) == (size_t)(stringEnd - string) && !std::memcmp(expectedString, string, stringEnd - string))) continue;
+		std::fprintf(stderr, "%016" PRIX64 " (%.17g) was written as %.*s instead of %s\n", std::bit_cast<uint64_t>(numbers[i]), numbers[i], (int)(stringEnd - string), string, expectedString);
+		failures++;
+	}
+
+	std::printf("%zu numbers, %" PRIu32 " failures\n", numbers.size(), failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+#include "../main.h"
+
+Trace::Scope::Scope(const char* const& name) : name(name) {
+	if (isEnabled) begin = std::chrono::steady_clock::now();
+}
+
+Trace::Scope::Scope(const char* const& name, const uint32_t& id, const uint64_t& size) : name(name), id(id), size(size), hasId(true) {
+	if (isEnabled) begin = std::chrono::steady_clock::now();
+}
+
+Trace::Scope::Scope(const char* const& name, const std::string& filePath) : name(name), filePath(&filePath) {
+	if (isEnabled) begin = std::chrono::steady_clock::now();
+}
+
+Trace::Scope::~Scope() {
+	if (isEnabled) add_event(*this);
+}
+
+void Trace::begin() {
+	startTime = std::chrono::steady_clock::now();
+	isEnabled = true;
+}
+
+bool Trace::write_file(const std::string& filePath) {
+	const auto write_string = [](std::string& json, const std::string& string)->void {
+		char escape[7];
+		json += '"';
+
+		for (uint32_t i = 0; i < string.size(); i++) {
+			switch (string[i]) {
+			case '"':
+				json += "\\\"";
+				continue;
+			case '\\':
+				json += "\\\\";
+				continue;
+			case '\b':
+				json += "\\b";
+				continue;
+			case '\f':
+				json += "\\f";
+				continue;
+			case '\n':
+				json += "\\n";
+				continue;
+			case '\r':
+				json += "\\r";
+				continue;
+			case '\t':
+				json += "\\t";
+				continue;
+			}
+
+			if ((uint8_t)string[i] < 0x20) {
+				std::snprintf(escape, sizeof(escape), "\\u%04X", (uint8_t)string[i]);
+				json += escape;
+				continue;
+			}
+
+			json += string[i];
+		}
+
+		json += '"';
+	};
+
+	isEnabled = false;
+	const std::lock_guard<std::mutex> lock(buffersMutex);
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	char buffer[128];
+	uint64_t eventCount;
+
+	for (uint32_t i = 0; i < buffers.size(); i++) {
+		std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", i ? "," : "", buffers[i]->threadId);
+		json += buffer;
+		json += buffers[i]->threadId == 1 ? "main" : "worker " + std::to_string(buffers[i]->threadId - 1);
+		json += "\"}}";
+		eventCount = buffers[i]->eventCount.load(std::memory_order_acquire);
+
+		for (uint64_t j = eventCount > BUFFER_SIZE ? eventCount - BUFFER_SIZE : 0; j < eventCount; j++) {
+			const Event& event = buffers[i]->events[j % BUFFER_SIZE];
+			std::snprintf(buffer, sizeof(buffer), ",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", event.name, buffers[i]->threadId, event.begin / 1e3, event.duration / 1e3);
+			json += buffer;
+
+			if (event.hasId) {
+				json += ",\"args\":{\"id\":" + std::to_string(event.id) + ",\"size\":" + std::to_string(event.size) + "}";
+			} else if (event.filePath.size()) {
+				json += ",\"args\":{\"file\":";
+				write_string(json, event.filePath);
+				json += "}";
+			}
+
+			json += "}";
+		}
+
+		delete buffers[i];
+	}
+
+	buffers.clear();
+	json += "]}";
+	OutputFile file;
+	return file.create(filePath) && file.write(json.data(), json.size());
+}
+
+Trace::Buffer& Trace::get_thread_buffer() {
+	static thread_local Buffer* buffer = nullptr;
+
+	if (!buffer) {
+		const std::lock_guard<std::mutex> lock(buffersMutex);
+		buffer = buffers.emplace_back(new Buffer);
+		buffer->threadId = buffers.size();
+	}
+
+	return *buffer;
+}
+
+void Trace::add_event(const Scope& scope) {
+	const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	Buffer& buffer = get_thread_buffer();
+	const uint64_t index = buffer.eventCount.load(std::memory_order_relaxed);
+	Event& event = buffer.events[index % BUFFER_SIZE];
+	event.name = scope.name;
+	event.begin = std::chrono::duration_cast<std::chrono::nanoseconds>(scope.begin - startTime).count();
+	event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - scope.begin).count();
+	event.id = scope.id;
+	event.size = scope.size;
+	event.hasId = scope.hasId;
+
+	if (scope.filePath) {
+		event.filePath = *scope.filePath;
+	} else {
+		event.filePath.clear();
+	}
+
+	buffer.eventCount.store(index + 1, std::memory_order_release);
+}
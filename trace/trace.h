@@ -0,0 +1,59 @@
+#ifdef DISABLE_TRACE
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ID(name, id, size)
+#define TRACE_SCOPE_FILE(name, filePath)
+#else
+#define TRACE_SCOPE(name) const Trace::Scope traceScope(name)
+#define TRACE_SCOPE_ID(name, id, size) const Trace::Scope traceScope(name, id, size)
+#define TRACE_SCOPE_FILE(name, filePath) const Trace::Scope traceScope(name, filePath)
+#endif
+
+class Trace {
+public:
+
+	struct Scope {
+		Scope(const char* const& name);
+		Scope(const char* const& name, const uint32_t& id, const uint64_t& size);
+		Scope(const char* const& name, const std::string& filePath);
+		~Scope();
+
+		const char* const name;
+		const std::string* const filePath = nullptr;
+		const uint32_t id = 0;
+		const uint64_t size = 0;
+		const bool hasId = false;
+		std::chrono::steady_clock::time_point begin;
+	};
+
+	static void begin();
+	static bool write_file(const std::string& filePath);
+
+	static inline bool isEnabled = false;
+
+private:
+
+	static constexpr uint32_t BUFFER_SIZE = 1 << 16;
+
+	struct Event {
+		const char* name = nullptr;
+		std::string filePath;
+		uint64_t begin = 0;
+		uint64_t duration = 0;
+		uint64_t size = 0;
+		uint32_t id = 0;
+		bool hasId = false;
+	};
+
+	struct Buffer {
+		Event events[BUFFER_SIZE];
+		std::atomic<uint64_t> eventCount = 0;
+		uint32_t threadId = 0;
+	};
+
+	static Buffer& get_thread_buffer();
+	static void add_event(const Scope& scope);
+
+	static inline std::chrono::steady_clock::time_point startTime;
+	static inline std::mutex buffersMutex;
+	static inline std::vector<Buffer*> buffers;
+};
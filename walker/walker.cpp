@@ -0,0 +1,85 @@
+#include "../main.h"
+
+DirectoryWalker::DirectoryWalker(const std::string& rootPath, const FileFilter& filter, const uint32_t& threadCount)
+	: rootPath(rootPath), filter(filter), threadCount(threadCount ? threadCount : 1), files(FILE_QUEUE_SIZE) {}
+
+DirectoryWalker::~DirectoryWalker() {
+	stop();
+
+	for (uint32_t i = threads.size(); i--;) {
+		threads[i].join();
+	}
+}
+
+void DirectoryWalker::operator()() {
+	directories.emplace_back();
+	activeThreads = threadCount;
+
+	for (uint32_t i = 0; i < threadCount; i++) {
+		threads.emplace_back(&DirectoryWalker::walk, this);
+	}
+}
+
+bool DirectoryWalker::next_file(File& file) {
+	return files.pop(file);
+}
+
+void DirectoryWalker::stop() {
+	{
+		const std::lock_guard<std::mutex> lock(directoriesMutex);
+		isStopped = true;
+	}
+
+	directoriesChanged.notify_all();
+	files.close();
+}
+
+void DirectoryWalker::walk() {
+	TRACE_SCOPE("DirectoryWalker::walk");
+	std::string path;
+	std::vector<DirectoryEntry> entries;
+	std::vector<std::string> folders;
+
+	while (next_directory(path)) {
+		entries.clear();
+		folders.clear();
+		read_directory(rootPath + path, entries);
+
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			if (entries[i].isDirectory) {
+				folders.emplace_back(path + entries[i].name + PATH_SEPARATOR);
+				continue;
+			}
+
+			if (filter(entries[i].name) && !files.push(File{ .path = path, .name = entries[i].name })) break;
+		}
+
+		finish_directory(folders);
+	}
+
+	if (activeThreads.fetch_sub(1) == 1) files.close();
+}
+
+bool DirectoryWalker::next_directory(std::string& path) {
+	std::unique_lock<std::mutex> lock(directoriesMutex);
+	directoriesChanged.wait(lock, [this] { return isStopped || directories.size() || !activeDirectories; });
+	if (isStopped || !directories.size()) return false;
+	path = std::move(directories.back());
+	directories.pop_back();
+	activeDirectories++;
+	return true;
+}
+
+void DirectoryWalker::finish_directory(std::vector<std::string>& folders) {
+	{
+		const std::lock_guard<std::mutex> lock(directoriesMutex);
+
+		for (uint32_t i = folders.size(); i--;) {
+			directories.emplace_back(std::move(folders[i]));
+		}
+
+		activeDirectories--;
+	}
+
+	directoriesChanged.notify_all();
+}
@@ -0,0 +1,37 @@
+class DirectoryWalker {
+public:
+
+	struct File {
+		std::string path;
+		std::string name;
+	};
+
+	typedef bool (*FileFilter)(const std::string& fileName);
+
+	DirectoryWalker(const std::string& rootPath, const FileFilter& filter, const uint32_t& threadCount);
+	~DirectoryWalker();
+
+	void operator()();
+	bool next_file(File& file);
+	void stop();
+
+private:
+
+	static constexpr uint32_t FILE_QUEUE_SIZE = 4096;
+
+	void walk();
+	bool next_directory(std::string& path);
+	void finish_directory(std::vector<std::string>& folders);
+
+	const std::string rootPath;
+	const FileFilter filter;
+	const uint32_t threadCount;
+	BoundedQueue<File> files;
+	std::vector<std::thread> threads;
+	std::atomic<uint32_t> activeThreads = 0;
+	std::mutex directoriesMutex;
+	std::condition_variable directoriesChanged;
+	std::vector<std::string> directories;
+	uint32_t activeDirectories = 0;
+	bool isStopped = false;
+};